@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// Counted by the global operator new/delete replacements in allocations.cpp
+struct Allocations
+{
+  std::uint64_t allocations;
+  std::uint64_t frees;
+
+  static auto count() -> Allocations;
+};
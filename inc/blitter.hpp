@@ -0,0 +1,38 @@
+#pragma once
+
+#include "sprite.hpp"
+
+#include <array>
+#include <curses.h>
+#include <utility>
+
+// Sprites are copied into a chtype framebuffer one row at a time. Rows up to
+// MaxUnrolledWidth wide use a copy unrolled at compile time, wider ones a loop
+constexpr int MaxUnrolledWidth = 8;
+
+template<int Width>
+inline void blitRow(chtype* dst, char const* src)
+{
+  [&]<std::size_t... I>(std::index_sequence<I...>) {
+    ((dst[I] = static_cast<unsigned char>(src[I])), ...);
+  }(std::make_index_sequence<Width>{});
+}
+
+template<int Width>
+void blitRows(chtype* dst, int dstStride, char const* src, int srcStride, int rows)
+{
+  for(int y{}; y < rows; ++y) {
+    blitRow<Width>(dst + y * dstStride, src + y * srcStride);
+  }
+}
+
+void blitRowsGeneric(chtype* dst, int dstStride, char const* src, int srcStride, int rows, int width);
+
+using BlitRows = void (*)(chtype*, int, char const*, int, int);
+
+inline constexpr auto unrolledBlitters = []<std::size_t... Width>(std::index_sequence<Width...>) {
+  return std::array<BlitRows, sizeof...(Width)>{&blitRows<Width>...};
+}(std::make_index_sequence<MaxUnrolledWidth + 1>{});
+
+// clips once against the framebuffer, then copies whole rows
+void blitSprite(Sprite const& sprite, YX<int> position, chtype* framebuffer, YX<int> framebufferSize);
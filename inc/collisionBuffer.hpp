@@ -1,38 +1,158 @@
 #pragma once
 
 #include "entity.hpp"
+#include "threadPool.hpp"
 
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+class Formation;
+
 class CollisionBuffer
 {
 public:
   static constexpr int Empty = 0;
   static constexpr int Invalid = -1;
+  static constexpr int ChunkSize = 32;
+
+  // cells of a shape that are set take part in a query, row major
+  struct Mask
+  {
+    YX<int> size;
+    std::span<bool const> cells;
+  };
 
-  CollisionBuffer(YX<int> gridSize, std::unordered_map<Entity::ID, Entity>& entities);
+  CollisionBuffer(YX<int> gridSize, std::unordered_map<Entity::ID, Entity>& entities, Formation const& formation);
 
   void add(Entity::ID);
   void paint(YX<int> start, YX<int> end);
   void remove(Entity::ID);
-  auto at(YX<int>) -> Entity::ID;
-  auto at(YX<float>) -> Entity::ID;
-  auto collides(Entity::ID id) -> std::vector<Entity::ID>;
-  void update();
-  auto raycast(YX<float> rayStart, YX<float> rayDir) -> Entity::ID;
+  auto at(YX<int>) const -> Entity::ID;
+  auto at(YX<float>) const -> Entity::ID;
+  // copies out.size() cells of a row starting at start, resolved like at()
+  void row(YX<int> start, std::span<Entity::ID> out) const;
+
+  // Queries report every entity found once, walls as Invalid. A visitor can
+  // return false to stop early. They share scratch state, so they are not
+  // const and a system using them has to declare the collisions as written
+  template<std::invocable<Entity::ID> Visitor>
+  void query(YX<int> start, YX<int> end, Visitor&& visit);
+  template<std::invocable<Entity::ID> Visitor>
+  void query(YX<int> start, Mask mask, Visitor&& visit);
+  // fills out with what a query finds, returns how many were written
+  auto query(YX<int> start, YX<int> end, std::span<Entity::ID> out) -> std::size_t;
+  // what overlaps the box of an entity, the entity itself left out
+  template<std::invocable<Entity::ID> Visitor>
+  void collides(Entity::ID id, Visitor&& visit);
+  auto collides(Entity::ID id, std::span<Entity::ID> out) -> std::size_t;
+  // stops at the first thing found
+  bool blocked(Entity::ID id);
+
+  // restamps every collider, one row of chunks per task
+  void update(ThreadPool& pool);
+  auto raycast(YX<float> rayStart, YX<float> rayDir) const -> Entity::ID;
+  auto chunkCount() const -> std::size_t { return m_chunks.size(); }
 
   // auto at(YX<int> index) -> int;
   // auto at(YX<float> index) -> int;
 
 private:
-  void map_entity(Entity::ID);
-  void unmap_entity(Entity::ID);
+  // The grid is split in chunks that only exist while something occupies them,
+  // so memory follows the occupied area rather than the grid size
+  struct Chunk
+  {
+    std::array<Entity::ID, ChunkSize * ChunkSize> cells{};    // colliders, cleared on every update
+    std::array<Entity::ID, ChunkSize * ChunkSize> geometry{}; // painted walls, kept
+    int occupied{};
+    int solid{};
+  };
+
+  // the cells [start, end) of a collider that fall in one row of chunks
+  struct Stamp
+  {
+    Entity::ID id;
+    YX<int> start;
+    YX<int> end;
+  };
+
+  bool contains(YX<int> pos) const;
+  auto chunk(YX<int> pos) const -> Chunk*;
+  auto allocateChunk(YX<int> pos) -> Chunk&;
+  static int cellIndex(YX<int> pos);
+  void stamp(Stamp const& stamp);
   // void set_collision(YX<int> pos);
-  void for_each_cell(Entity::ID, std::function<void(YX<int>)>);
+  auto box(Entity::ID id) const -> std::array<YX<int>, 2>;
+  void beginVisit();
+  bool firstVisit(Entity::ID id);
+  template<typename Visitor>
+  void scan(YX<int> start, YX<int> end, Mask const* mask, Entity::ID ignore, Visitor& visit);
 
   std::unordered_map<Entity::ID, Entity>& m_entities;
+  Formation const& m_formation; // stamped on its own, checked under the free colliders
   std::vector<Entity::ID> m_collidersIDs;
-  std::unordered_map<YX<int>, Entity::ID> m_cells;
-  YX<int> m_gridSize;
+  std::unordered_map<Entity::ID, std::size_t> m_colliderIndex;
+  YX<int> m_gridSize; // outside the grid counts as Invalid
+  std::unordered_map<YX<int>, std::unique_ptr<Chunk>> m_chunks;
+  std::vector<std::unique_ptr<Chunk>> m_freeChunks;
+  std::vector<Chunk*> m_staleChunks;
+  std::vector<std::vector<Stamp>> m_bands; // per row of chunks, reused
+
+  // the query an entity was last reported by, indexed by ID + 1 so Invalid
+  // fits. Sized in update(), queries never allocate
+  std::vector<std::uint32_t> m_visited;
+  std::uint32_t m_visit;
 };
+
+template<typename Visitor>
+void CollisionBuffer::scan(YX<int> start, YX<int> end, Mask const* mask, Entity::ID ignore, Visitor& visit)
+{
+  beginVisit();
+  std::array<Entity::ID, ChunkSize> cells;
+  for(int y = start.y; y < end.y; ++y) {
+    for(int x = start.x; x < end.x; x += ChunkSize) {
+      int length = std::min(ChunkSize, end.x - x);
+      row(YX<int>{y, x}, std::span{cells.data(), static_cast<std::size_t>(length)});
+      for(int i{}; i < length; ++i) {
+        if(mask != nullptr && !mask->cells[(y - start.y) * mask->size.x + (x - start.x) + i]) {
+          continue;
+        }
+        Entity::ID id = cells[i];
+        if(id == CollisionBuffer::Empty || id == ignore || !firstVisit(id)) {
+          continue;
+        }
+        if constexpr(std::is_void_v<std::invoke_result_t<Visitor&, Entity::ID>>) {
+          visit(id);
+        } else if(!visit(id)) {
+          return;
+        }
+      }
+    }
+  }
+}
+
+template<std::invocable<Entity::ID> Visitor>
+void CollisionBuffer::query(YX<int> start, YX<int> end, Visitor&& visit)
+{
+  scan(start, end, nullptr, CollisionBuffer::Empty, visit);
+}
+
+template<std::invocable<Entity::ID> Visitor>
+void CollisionBuffer::query(YX<int> start, Mask mask, Visitor&& visit)
+{
+  YX<int> end{start.y + mask.size.y, start.x + mask.size.x};
+  scan(start, end, &mask, CollisionBuffer::Empty, visit);
+}
+
+template<std::invocable<Entity::ID> Visitor>
+void CollisionBuffer::collides(Entity::ID id, Visitor&& visit)
+{
+  auto [start, end] = box(id);
+  scan(start, end, nullptr, id, visit);
+}
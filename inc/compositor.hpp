@@ -0,0 +1,62 @@
+#pragma once
+
+#include "framebuffer.hpp"
+#include "recorder.hpp"
+
+#include <array>
+#include <curses.h>
+#include <vector>
+
+// Stacks cached layers of cells into the terminal. Layers are only read when
+// part of them was marked dirty, and only cells that changed on screen are
+// handed to curses
+class Compositor
+{
+public:
+  static constexpr chtype Transparent = 0;
+
+  // bottom to top
+  enum class Layer
+  {
+    background,
+    field,
+    hud,
+    overlay,
+    count,
+  };
+
+  struct Rect
+  {
+    YX<int> start;
+    YX<int> end; // exclusive
+  };
+
+  void resize(YX<int> screen);
+  // cells are owned by the caller and must outlive the compositor
+  void place(Layer layer, Framebuffer const* cells, YX<int> origin);
+  void show(Layer layer, bool visible);
+  // rect is relative to the layer
+  void markDirty(Layer layer, Rect rect);
+  void markDirty(Layer layer);
+  // every change presented is also handed to the recorder, nullptr stops it
+  void record(Recorder* recorder) { m_recorder = recorder; }
+
+  // composes what is dirty and refreshes the terminal if anything changed
+  void present();
+
+private:
+  struct Entry
+  {
+    Framebuffer const* cells{};
+    YX<int> origin{};
+    bool visible{true};
+  };
+
+  auto compose(YX<int> pos) const -> chtype;
+  void markScreenDirty(Rect rect);
+
+  std::array<Entry, static_cast<std::size_t>(Layer::count)> m_layers{};
+  Framebuffer m_screen{}; // what curses was last given
+  std::vector<Rect> m_dirty{};
+  Recorder* m_recorder{};
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "yx.hpp"
+
+#include <filesystem>
+
+struct Config
+{
+  // Pacing, per second
+  float tickRate{48};
+  float frameRate{24};
+  int threads{0}; // simulation threads, 0 uses every core
+
+  // Arena
+  YX<int> arenaSize{32, 64};
+
+  // Formation
+  YX<int> alienFormation{5, 8}; // rows, columns
+  YX<int> alienStartingPoint{3, 9};
+  YX<int> alienSpacing{2, 2};
+  float alienSpeed{3};
+  float alienSpeedup{0.25}; // added to the speed for every alien killed
+  float alienSway{4};       // how far the formation travels before turning back
+  int alienFireInterval{30};    // ms per living alien
+  int alienFireMinInterval{250}; // ms
+
+  // Ship
+  int shipHealth{8};
+  float shipStep{0.33}; // cells per keystroke
+  float shipBulletSpeed{8};
+  int shipFireInterval{300}; // ms
+
+  static constexpr YX<int> minArenaSize{8, 16};
+  static constexpr YX<int> maxArenaSize{1 << 16, 1 << 16};
+  static constexpr int maxAliens{1 << 20};
+  static constexpr int maxThreads{256};
+
+  static auto load(std::filesystem::path path) -> Config;
+  void validate() const;
+};
@@ -14,13 +14,22 @@ public:
 
   Entity(YX<float> pos, YX<float> vel, int health, std::shared_ptr<Sprite> sprite);
   Entity(Entity&& other);
+  Entity& operator=(Entity const&) = delete;
+  Entity& operator=(Entity&&) = delete;
   ~Entity();
 
 
+  // relative to the anchor when the entity has one (formation members)
   YX<float>& position() { return m_position; }
+  YX<float> const& position() const { return m_position; }
+  YX<float> worldPosition() const { return m_anchor != nullptr ? *m_anchor + m_position : m_position; }
+  void anchor(YX<float> const* origin) { m_anchor = origin; }
   YX<float>& velocity() { return m_velocity; }
+  YX<float> const& velocity() const { return m_velocity; }
   int& health() { return m_health; }
+  int health() const { return m_health; }
   Sprite& sprite() { return *m_sprite; }
+  Sprite const& sprite() const { return *m_sprite; }
   ID id() const
   {
     assert(m_id != -1 && "Invalid ID");
@@ -34,6 +43,7 @@ private:
   ID m_id{-1};
   YX<float> m_position{0, 0};
   YX<float> m_velocity{0, 0};
+  YX<float> const* m_anchor{nullptr};
   int m_health{1};
   std::shared_ptr<Sprite> m_sprite; // the easy way
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "entity.hpp"
+
+#include <functional>
+#include <optional>
+#include <random>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Aliens of the formation sit at fixed offsets from a single origin. Only the
+// origin moves, so their collision stamp is built once and never redrawn
+class Formation
+{
+public:
+  Formation(int columns);
+
+  void place(YX<float> origin, YX<int> extent);
+  YX<float>& origin() { return m_origin; }
+
+  // aliens must be added from the top row down
+  void add(int column, Entity::ID, YX<int> offset, YX<int> size);
+  void remove(Entity::ID);
+  auto at(YX<int> pos) const -> Entity::ID;
+  // writes the aliens of a row starting at start into the empty cells of out
+  void row(YX<int> start, std::span<Entity::ID> out) const;
+  // calls fun once for every alien with a cell inside [start, end)
+  void forEachMember(YX<int> start, YX<int> end, std::function<void(Entity::ID)> fun) const;
+  auto shooter(std::mt19937& random) -> std::optional<Entity::ID>;
+
+private:
+  struct Member
+  {
+    int column;
+    YX<int> offset;
+    YX<int> size;
+  };
+
+  void stamp(Member const& member, Entity::ID id);
+  void retireColumn(int column);
+
+  YX<float> m_origin{};
+  YX<int> m_extent{};
+  std::vector<Entity::ID> m_cells{}; // row major, relative to the origin
+
+  // living aliens of each column, top to bottom. The back is the front line
+  std::vector<std::vector<Entity::ID>> m_columns;
+  // columns that still have living aliens and where each one sits in that list
+  std::vector<int> m_liveColumns{};
+  std::vector<int> m_liveIndex;
+  std::unordered_map<Entity::ID, Member> m_members{};
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+
+// Paces a loop to fixed deadlines. It sleeps until shortly before each deadline
+// and spins the rest of the way. The spin margin adapts to how much the
+// host oversleeps
+class FrameScheduler
+{
+  using Clock = std::chrono::steady_clock;
+
+public:
+  struct Budget
+  {
+    float work{};         // seconds spent between waits, smoothed
+    float load{};         // fraction of the period spent working
+    int overruns{};       // deadlines that had already passed when wait() was called
+    float worstOverrun{}; // seconds
+  };
+
+  FrameScheduler(float rate);
+
+  // returns the time since the previous wait() in seconds
+  auto wait() -> float;
+  auto budget() const -> Budget { return m_budget; }
+
+private:
+  void sleepUntil(Clock::time_point deadline);
+
+  Clock::duration m_period;
+  Clock::time_point m_deadline;
+  Clock::time_point m_previous;
+  Clock::duration m_spinMargin{std::chrono::microseconds(500)};
+  Budget m_budget{};
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "sprite.hpp"
+
+#include <curses.h>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Grid of terminal cells. Every write is clipped to the buffer
+class Framebuffer
+{
+public:
+  Framebuffer() = default;
+  Framebuffer(YX<int> size);
+
+  void resize(YX<int> size);
+  YX<int> size() const { return m_size; }
+  bool contains(YX<int> pos) const;
+  bool overlaps(YX<int> pos, YX<int> size) const;
+
+  void clear(chtype fill = ' ');
+  void set(YX<int> pos, chtype cell);
+  void fill(YX<int> start, YX<int> end, chtype cell);
+  void print(YX<int> pos, std::string_view text, chtype attributes = 0);
+  auto at(YX<int> pos) const -> chtype;
+  auto row(int y) const -> std::span<chtype const>;
+  void blit(Sprite const& sprite, YX<int> pos);
+
+  bool operator==(Framebuffer const&) const = default;
+
+private:
+  YX<int> m_size{0, 0};
+  std::vector<chtype> m_cells{};
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "collisionBuffer.hpp"
+#include "config.hpp"
+#include "entity.hpp"
+#include "inputReader.hpp"
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Decides which keys are pressed on each tick, either by reading the keyboard
+// or by looking at the game like a player would
+class InputPolicy
+{
+public:
+  using Event = InputReader::Event;
+
+  // what a policy may look at, read only
+  struct View
+  {
+    std::chrono::steady_clock::time_point now; // simulation time
+    Config const& config;
+    Entity const& ship;
+    std::unordered_map<Entity::ID, Entity> const& entities;
+    std::vector<Entity::ID> const& aliens;
+    std::vector<Entity::ID> const& bullets;
+    CollisionBuffer const& collisions;
+  };
+
+  virtual ~InputPolicy() = default;
+  // appends the keys pressed since the last tick
+  virtual void poll(View const& view, std::vector<Event>& events) = 0;
+};
+
+class KeyboardPolicy : public InputPolicy
+{
+public:
+  KeyboardPolicy(InputReader& reader) :
+    m_reader{reader}
+  {
+  }
+  void poll(View const& view, std::vector<Event>& events) override;
+
+private:
+  InputReader& m_reader;
+};
+
+class IdlePolicy : public InputPolicy
+{
+public:
+  void poll(View const&, std::vector<Event>&) override {}
+};
+
+class RandomPolicy : public InputPolicy
+{
+public:
+  RandomPolicy(std::uint32_t seed) :
+    m_random{seed}
+  {
+  }
+  void poll(View const& view, std::vector<Event>& events) override;
+
+private:
+  std::mt19937 m_random;
+};
+
+class SpamFirePolicy : public InputPolicy
+{
+public:
+  void poll(View const& view, std::vector<Event>& events) override;
+};
+
+// steps out of the way of alien bullets about to reach the ship, otherwise
+// walks under the nearest alien and fires when the line above the gun is clear to it
+class DodgeAndShootPolicy : public InputPolicy
+{
+public:
+  void poll(View const& view, std::vector<Event>& events) override;
+
+private:
+  static constexpr float Horizon = 1.5f; // seconds a bullet is watched before it lands
+  static constexpr float Margin = 2.f;   // cells kept between a landing bullet and the ship
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "spscRing.hpp"
+
+#include <chrono>
+#include <optional>
+#include <stop_token>
+#include <thread>
+
+// Reads keystrokes from stdin on its own thread as soon as they arrive
+class InputReader
+{
+public:
+  struct Event
+  {
+    int key;
+    std::chrono::steady_clock::time_point time;
+  };
+
+  InputReader();
+  ~InputReader();
+  InputReader(InputReader const&) = delete;
+  InputReader& operator=(InputReader const&) = delete;
+
+  void start();
+  void stop();
+  auto pop() -> std::optional<Event>;
+
+private:
+  void read(std::stop_token stop);
+
+  int m_wakeup[2]{-1, -1}; // pipe used to interrupt poll() when stopping
+  SpscRing<Event, 256> m_events{};
+  std::jthread m_thread{};
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "tripleBuffer.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Metrics
+{
+  std::uint64_t tick{};
+  int entities{};
+  int aliens{};
+  int bullets{};
+  int collisionChunks{};
+  float tickTime{}; // seconds
+  int tickOverruns{};
+  float frameTime{}; // seconds
+  int frameOverruns{};
+  std::uint64_t allocations{};
+  std::uint64_t frees{};
+
+  auto format() const -> std::string;
+};
+
+// Serves the latest Metrics as one text line per update to every client of a
+// Unix domain socket. publish() only swaps a buffer, the socket work happens on
+// a background thread and slow clients are dropped instead of waited for
+class MetricsPublisher
+{
+public:
+  MetricsPublisher(std::filesystem::path socketPath);
+  ~MetricsPublisher();
+  MetricsPublisher(MetricsPublisher const&) = delete;
+  MetricsPublisher& operator=(MetricsPublisher const&) = delete;
+
+  void publish(Metrics const& metrics);
+
+private:
+  void serve(std::stop_token stop);
+  void acceptClients();
+  void send(std::string const& line);
+
+  std::filesystem::path m_socketPath;
+  int m_listener{-1};
+  std::vector<int> m_clients{};
+  TripleBuffer<Metrics> m_metrics{};
+  std::jthread m_thread{};
+};
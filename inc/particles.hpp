@@ -0,0 +1,38 @@
+#pragma once
+
+#include "yx.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Sparks thrown by hits and deaths. They never collide and live outside the
+// entities, in fixed size arrays per field so update() is a straight loop
+// the compiler vectorizes
+class Particles
+{
+public:
+  static constexpr std::size_t Capacity = 1 << 14;
+
+  Particles(std::uint32_t seed = 1);
+
+  // bursts past the capacity are cut short
+  void burst(YX<float> position, int count, float speed, float life);
+  void update(float timeStep);
+
+  auto size() const -> std::size_t { return m_count; }
+  auto position(std::size_t i) const -> YX<float> { return {m_y[i], m_x[i]}; }
+  auto life(std::size_t i) const -> float { return m_life[i]; }
+
+private:
+  static constexpr float Drag = 3.f; // fraction of the speed lost per second
+
+  std::vector<float> m_y;
+  std::vector<float> m_x;
+  std::vector<float> m_vy;
+  std::vector<float> m_vx;
+  std::vector<float> m_life; // seconds left
+  std::size_t m_count{};
+  std::minstd_rand m_random;
+};
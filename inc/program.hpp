@@ -1,47 +1,104 @@
 #pragma once
 
 #include "collisionBuffer.hpp"
+#include "config.hpp"
 #include "entity.hpp"
+#include "formation.hpp"
+#include "inputPolicy.hpp"
+#include "inputReader.hpp"
+#include "metrics.hpp"
+#include "particles.hpp"
+#include "renderer.hpp"
+#include "snapshot.hpp"
 #include "sprite.hpp"
+#include "systemScheduler.hpp"
+#include "threadPool.hpp"
+#include "tickScheduler.hpp"
+#include "tripleBuffer.hpp"
 
-#include <curses.h>
-#include <list>
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <random>
+#include <stop_token>
+#include <vector>
 
 class Program
 {
   using Path = std::filesystem::path;
 
 public:
-  Program(Path sprite_path);
-  ~Program();
+  Program(Path sprite_path, Config config);
   void run();
+  // runs as fast as possible without a terminal, returns the ticks simulated
+  auto runHeadless(InputPolicy& policy, std::uint64_t ticks) -> std::uint64_t;
+  void enableMetrics(Path socket_path);
+  // the session is recorded once run() takes over the terminal
+  void enableRecording(Path record_path) { m_recordPath = record_path; }
+  void seed(std::uint32_t seed) { m_random.seed(seed); }
 
 private:
-  void initCurses();
-  void createWindows();
   void loadSprites(Path path);
   void createEntities();
-  void endCurses();
+  void createSystems();
+  void createScripts();
 
   // void loadArena(Path sprites_path);
-  // void drawSprite(WINDOW* win, Entity& entity);
-  void drawSprite(std::vector<chtype>& buffer, Entity& entity);
-  void render(float frameDuration);
-  void startingScreen();
-  void endingScreen();
-  bool updateFramebuffer();
-  void logic(int input, float ts, bool& force);
+  void input(InputReader::Event const& event, bool& force);
+  void logic(float ts, InputPolicy& policy, bool& force);
+
+  // Systems, see createSystems() for the data each one touches
+  void inputSystem();
+  void gameStateSystem();
+  void formationSystem();
+  void bulletSystem(std::size_t begin, std::size_t end);
+  void hitSystem(std::size_t begin, std::size_t end);
+  void bulletSweepSystem();
+  void alienSweepSystem();
+
+  // Scripts, resumed by the scripts system as their ticks or events come up
+  auto alienFireScript() -> TickScheduler::Task;
+  auto shipGunScript() -> TickScheduler::Task;
+  auto formationScript() -> TickScheduler::Task;
+
+  void snapshot(Snapshot& snapshot);
+  auto viewSize() const -> YX<int>;
+  void renderLoop(std::stop_token stop);
+  void publishMetrics();
 
   auto spawnEntity(YX<float> pos, YX<float> vel, int health, std::shared_ptr<Sprite>& sprite) -> Entity::ID;
   void paintBorders();
 
 private:
-  // Windows
-  WINDOW* m_arenaWin;
-  WINDOW* m_arenaBorderWin;
+  // Configuration
+  Config m_config;
+
+  // Simulation, the state of the tick being run is kept for the systems
+  ThreadPool m_threadPool{static_cast<unsigned>(m_config.threads)};
+  SystemScheduler m_systems{};
+  float m_timeStep{};
+  InputPolicy* m_policy{};
+  bool m_forceRender{};
+
+  // Scripts, counted in ticks so headless runs repeat exactly
+  TickScheduler m_scripts{m_config.tickRate};
+  TickScheduler::Event m_fireRequested{m_scripts};
+  TickScheduler::Event m_formationAtEdge{m_scripts};
+
+  // Rendering, only touched by the render thread while the game is running
+  std::optional<Renderer> m_renderer{}; // not created when headless
+  TripleBuffer<Snapshot> m_snapshots{};
+  std::atomic<float> m_frameTime{};
+  std::atomic<int> m_frameOverruns{};
+  Path m_recordPath{}; // empty when not recording
+
+  // Metrics, only when enabled
+  std::unique_ptr<MetricsPublisher> m_metrics{};
+
+  // Input
+  InputReader m_inputReader{};
+  std::vector<InputPolicy::Event> m_events{};
+  float m_inputLatency{}; // oldest keystroke handled in the last tick, in seconds
 
   // Sprites
   struct
@@ -57,18 +114,17 @@ private:
   struct
   {
     Entity::ID ship{};
-    std::list<Entity::ID> aliens{};
-    std::list<Entity::ID> bullets{};
+    std::vector<Entity::ID> aliens{};
+    std::vector<Entity::ID> bullets{};
   } m_entityIDs;
 
   // Miscellaneous
-  YX<int> m_arenaSize{32, 64};
-  YX<int> m_alienFormation{5, 8};
   YX<float> m_alienPosOffset;
-  YX<float> m_alienVelocity{0, 3};
-  YX<int> m_alienStartingPoint{3, 9};
+  YX<float> m_alienVelocity{0, m_config.alienSpeed};
   bool m_debugMode = false;
-  std::vector<chtype> m_framebuffer{};
+  FrameScheduler::Budget m_tickBudget{};
+  std::uint64_t m_tick{};
+  std::chrono::steady_clock::time_point m_now{}; // simulation time of the current tick
   std::mt19937 m_random{};
 
   enum class GameState
@@ -80,6 +136,12 @@ private:
     quitted,
   } m_gameState{GameState::running};
 
+  // Effects, never collide
+  Particles m_particles{};
+
+  // Formation
+  Formation m_formation{m_config.alienFormation.x};
+
   // CollisionBuffer
-  CollisionBuffer m_collisionBuffer{m_arenaSize, m_entities};
+  CollisionBuffer m_collisionBuffer{m_config.arenaSize, m_entities, m_formation};
 };
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "spscRing.hpp"
+#include "yx.hpp"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <curses.h>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records what goes to the terminal as an asciicast v2 file. The renderer only
+// copies the cells it changed into a preallocated frame, encoding and writing
+// happen on a background thread. When the writer falls behind frames are
+// merged into the one still being filled, and a frame too large to merge is
+// dropped and followed by a full screen instead of ever waiting for the disk
+class Recorder
+{
+public:
+  struct Stats
+  {
+    std::uint64_t frames{};
+    std::uint64_t coalesced{};
+    std::uint64_t dropped{};
+  };
+
+  Recorder(std::filesystem::path path, YX<int> screenSize);
+  ~Recorder();
+  Recorder(Recorder const&) = delete;
+  Recorder& operator=(Recorder const&) = delete;
+
+  // renderer, cells are copied
+  void cells(YX<int> pos, std::span<chtype const> cells);
+  // true when the whole screen has to be passed next, replacing this frame
+  bool keyframe();
+  void endFrame();
+  auto stats() const -> Stats const& { return m_stats; }
+
+private:
+  static constexpr std::size_t Slots = 16;
+
+  struct Run
+  {
+    YX<int> pos;
+    std::uint32_t offset;
+    std::uint32_t length;
+  };
+
+  struct Frame
+  {
+    double time{}; // seconds since the recording started, keeps sub-millisecond precision for long sessions
+    bool keyframe{};
+    std::vector<Run> runs{};
+    std::vector<chtype> cells{};
+
+    void clear();
+  };
+
+  void write(std::stop_token stop);
+  void flush();
+  void encode(Frame const& frame);
+  void writeBatch();
+
+  std::FILE* m_file{};
+  std::chrono::steady_clock::time_point m_start{std::chrono::steady_clock::now()};
+
+  // renderer side
+  std::array<Frame, Slots> m_frames{};
+  std::size_t m_current{};
+  bool m_keyframe{true};
+  bool m_overflowed{};
+  Stats m_stats{};
+
+  // slots go to the writer filled and come back empty
+  SpscRing<std::size_t, Slots> m_filled{};
+  SpscRing<std::size_t, Slots> m_free{};
+
+  // writer side
+  std::string m_batch{};
+  std::filesystem::path m_path;
+  int m_error{}; // errno of the first failed write, nothing is written after it
+  std::mutex m_mutex{};
+  std::condition_variable_any m_wake{};
+  std::jthread m_thread{};
+};
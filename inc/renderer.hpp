@@ -0,0 +1,73 @@
+#pragma once
+
+#include "compositor.hpp"
+#include "config.hpp"
+#include "frameScheduler.hpp"
+#include "framebuffer.hpp"
+#include "recorder.hpp"
+#include "snapshot.hpp"
+
+#include <array>
+#include <curses.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Owns the terminal. Only one thread at a time may call into it
+class Renderer
+{
+public:
+  Renderer(Config const& config);
+  ~Renderer();
+  Renderer(Renderer const&) = delete;
+  Renderer& operator=(Renderer const&) = delete;
+
+  YX<int> viewSize() const;
+  void render(Snapshot const& snapshot, float frameDuration, FrameScheduler::Budget frameBudget = {});
+  void startingScreen(Snapshot const& snapshot);
+  void endingScreen(std::string const& message);
+  // records every frame presented from now on
+  void record(std::filesystem::path path);
+
+private:
+  void initCurses();
+  void createLayers(YX<int> arenaSize);
+  void endCurses();
+
+  // void drawSprite(WINDOW* win, Entity& entity);
+  void drawSprite(Framebuffer& framebuffer, Snapshot::Drawable const& drawable);
+  void updateFramebuffer(Snapshot const& snapshot);
+  void drawCollisions(Snapshot const& snapshot);
+  void markFieldChanges();
+  template<typename... Args>
+  void hudLine(int line, YX<int> pos, char const* format, Args... args);
+  void clearHudLine(int line);
+
+private:
+  // Screen layout
+  YX<int> m_screenSize{};
+  YX<int> m_arenaOrigin{}; // top left cell of the view on screen
+  YX<int> m_viewSize{};
+
+  // Layers, only the field changes every frame
+  Compositor m_compositor{};
+  Framebuffer m_background{};
+  Framebuffer m_framebuffer{};
+  Framebuffer m_previousFramebuffer{};
+  Framebuffer m_hud{};
+  Framebuffer m_overlay{};
+
+  // the debug overlay lines, then the health
+  static constexpr int HealthLine = 12;
+  struct HudLine
+  {
+    YX<int> pos{};
+    std::string text{};
+  };
+  std::array<HudLine, HealthLine + 1> m_hudLines{};
+
+  std::vector<Snapshot::Drawable const*> m_drawList{};
+
+  std::unique_ptr<Recorder> m_recorder{}; // only when recording
+};
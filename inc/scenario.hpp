@@ -0,0 +1,29 @@
+#pragma once
+
+#include "config.hpp"
+#include "inputPolicy.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A repeatable game played by a bot, the standard performance workload
+struct Scenario
+{
+  std::string name;
+  Config config;
+  std::function<std::unique_ptr<InputPolicy>()> policy;
+  std::uint64_t ticks;
+  std::uint32_t seed;
+
+  static auto builtin() -> std::vector<Scenario>;
+};
+
+// plays every scenario whose name contains filter without a terminal and
+// prints the ticks simulated per second of wall time
+void runScenarios(std::filesystem::path sprite_path, std::string_view filter, std::ostream& out);
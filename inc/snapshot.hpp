@@ -0,0 +1,56 @@
+#pragma once
+
+#include "entity.hpp"
+#include "frameScheduler.hpp"
+#include "sprite.hpp"
+
+#include <vector>
+
+// Everything the renderer needs from one simulation tick
+struct Snapshot
+{
+  // drawn in this order, later layers on top
+  enum class Layer
+  {
+    formation,
+    bullets,
+    ship,
+  };
+
+  struct Drawable
+  {
+    YX<int> position;
+    Sprite const* sprite; // sprites are loaded once and outlive the renderer
+    Layer layer;
+  };
+
+  // drawn over every layer
+  struct Spark
+  {
+    YX<int> position;
+    float life; // seconds left
+  };
+
+  struct Hud
+  {
+    YX<float> ship{};
+    int shipHealth{};
+    int bulletCount{};
+    int alienCount{};
+    float alienVelocity{};
+    float inputLatency{};
+    FrameScheduler::Budget tickBudget{};
+    int chunkCount{};
+    int particleCount{};
+  };
+
+  // positions are relative to the camera, the top left corner of the view in the arena
+  YX<int> camera{};
+  std::vector<Drawable> drawables{};
+  std::vector<Spark> sparks{};
+  Hud hud{};
+
+  // debug mode only, one cell per view cell
+  bool debugMode{false};
+  std::vector<Entity::ID> collisions{};
+};
@@ -13,9 +13,10 @@ public:
   Sprite(std::filesystem::path path);
   ~Sprite() = default;
 
-  wchar_t operator[](int index);
-  YX<int> size();
-  int bufferSize();
+  wchar_t operator[](int index) const;
+  char const* row(int y) const;
+  YX<int> size() const;
+  int bufferSize() const;
 
 private:
   void loadSprite(std::filesystem::path path);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread
+template<typename T, std::size_t Capacity>
+class SpscRing
+{
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+  // producer, returns false when the ring is full
+  bool push(T const& value)
+  {
+    std::size_t head = m_head.load(std::memory_order_relaxed);
+    if(head - m_tail.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    m_slots[head & (Capacity - 1)] = value;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer
+  std::optional<T> pop()
+  {
+    std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if(tail == m_head.load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+    T value = m_slots[tail & (Capacity - 1)];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return value;
+  }
+
+private:
+  std::array<T, Capacity> m_slots{};
+  alignas(64) std::atomic<std::size_t> m_head{0};
+  alignas(64) std::atomic<std::size_t> m_tail{0};
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "threadPool.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Game data a system can touch, as bits of System::reads and System::writes
+namespace Component
+{
+enum : unsigned
+{
+  input = 1 << 0,
+  gameState = 1 << 1, // state, debug mode
+  ship = 1 << 2,      // ship position
+  formation = 1 << 3, // origin and velocity
+  bullets = 1 << 4,   // bullet positions
+  health = 1 << 5,
+  entities = 1 << 6, // which entities exist
+  collisions = 1 << 7,
+  random = 1 << 8,
+  particles = 1 << 9,
+  scripts = 1 << 10, // tasks and events of the tick scheduler
+};
+}
+
+struct System
+{
+  char const* name;
+  unsigned reads{};
+  unsigned writes{};
+  // items the system splits over ranges of grain, serial systems leave it
+  // empty and get a single [0, 1) range
+  std::function<std::size_t()> count{};
+  std::size_t grain{1};
+  std::function<void(std::size_t begin, std::size_t end)> update;
+
+  bool conflicts(System const& other) const
+  {
+    return (writes & (other.reads | other.writes)) != 0 || (other.writes & reads) != 0;
+  }
+};
+
+// Runs systems in stages. A system goes in the stage after the last earlier
+// system it conflicts with, so the order they are added in is only kept
+// between systems sharing data. Each stage runs on the pool at once
+class SystemScheduler
+{
+public:
+  void add(System system);
+  // proceed() is checked before every stage, a false stops the update there
+  void run(ThreadPool& pool, std::function<bool()> const& proceed);
+  auto stages() const -> std::size_t { return m_stages.size(); }
+
+private:
+  struct Range
+  {
+    System const* system;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  std::vector<System> m_systems{};
+  std::vector<std::vector<std::size_t>> m_stages{}; // indices into m_systems
+  std::vector<std::size_t> m_stageOf{};
+  std::vector<Range> m_ranges{}; // reused by every stage
+};
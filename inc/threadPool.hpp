@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that split a batch of tasks with the caller.
+// dispatch() only returns once every task ran, so tasks may reference the
+// caller's stack
+class ThreadPool
+{
+public:
+  // threads counts the caller, 0 uses every core
+  ThreadPool(unsigned threads = 0);
+  ~ThreadPool();
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  auto size() const -> unsigned { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+  // calls task(i) for every i in [0, tasks). Not reentrant, a task must not dispatch
+  void dispatch(std::size_t tasks, std::function<void(std::size_t)> const& task);
+  // calls fun(begin, end) over [0, count) in ranges of up to grain items
+  void parallelFor(std::size_t count, std::size_t grain, std::function<void(std::size_t, std::size_t)> const& fun);
+
+private:
+  void work(std::stop_token stop);
+  void runTasks(std::function<void(std::size_t)> const* task, std::size_t tasks);
+
+  std::vector<std::jthread> m_workers{};
+  std::mutex m_mutex{};
+  std::condition_variable_any m_wake{};
+  std::condition_variable m_done{};
+
+  // the current batch, replaced under the mutex once no worker is inside it
+  std::function<void(std::size_t)> const* m_task{};
+  std::size_t m_tasks{};
+  std::uint64_t m_batch{};
+  int m_active{}; // workers inside the current batch
+  std::atomic<std::size_t> m_next{};
+  std::atomic<std::size_t> m_pending{};
+};
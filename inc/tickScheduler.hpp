@@ -0,0 +1,113 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Runs scripted behaviours as coroutines that co_await simulation ticks or
+// events. Sleeping tasks sit in a timer wheel and advance() only looks at the
+// slot of the current tick, so idle timers cost nothing
+class TickScheduler
+{
+public:
+  class Task
+  {
+  public:
+    struct promise_type
+    {
+      auto get_return_object() -> Task { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+      auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+      auto final_suspend() noexcept -> std::suspend_always { return {}; }
+      void return_void() {}
+      // thrown out of advance()
+      void unhandled_exception() { throw; }
+    };
+
+    Task(Task&& other) noexcept;
+    ~Task();
+    Task(Task const&) = delete;
+    Task& operator=(Task const&) = delete;
+
+  private:
+    explicit Task(std::coroutine_handle<promise_type> handle) :
+      m_handle{handle}
+    {
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+    friend class TickScheduler;
+  };
+
+  struct Sleep
+  {
+    TickScheduler& scheduler;
+    std::uint64_t ticks;
+
+    bool await_ready() const noexcept { return ticks == 0; }
+    void await_suspend(std::coroutine_handle<> handle) { scheduler.wakeAt(handle, scheduler.now() + ticks); }
+    void await_resume() const noexcept {}
+  };
+
+  // tasks waiting on an event resume on the next advance() when it is triggered
+  // outside of one, and later in the same advance() when a task triggers it
+  class Event
+  {
+  public:
+    Event(TickScheduler& scheduler) :
+      m_scheduler{scheduler}
+    {
+    }
+
+    void trigger();
+
+    struct Awaiter
+    {
+      Event& event;
+
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> handle) { event.m_waiters.push_back(handle); }
+      void await_resume() const noexcept {}
+    };
+    auto operator co_await() -> Awaiter { return Awaiter{*this}; }
+
+  private:
+    TickScheduler& m_scheduler;
+    std::vector<std::coroutine_handle<>> m_waiters{};
+  };
+
+  TickScheduler(float tickRate, std::size_t slots = 256);
+  ~TickScheduler();
+  TickScheduler(TickScheduler const&) = delete;
+  TickScheduler& operator=(TickScheduler const&) = delete;
+
+  // the task starts on the next advance()
+  void spawn(Task task);
+  // resumes every task due this tick, then moves on to the next one
+  void advance();
+
+  auto sleep(std::uint64_t ticks) -> Sleep { return Sleep{*this, ticks}; }
+  // rounded up to whole ticks
+  auto sleep(std::chrono::milliseconds duration) -> Sleep;
+  auto now() const -> std::uint64_t { return m_now; }
+  auto tasks() const -> std::size_t { return m_tasks.size(); }
+
+private:
+  struct Timer
+  {
+    std::coroutine_handle<> handle;
+    std::uint64_t due;
+  };
+
+  void wakeAt(std::coroutine_handle<> handle, std::uint64_t tick);
+  void resume(std::coroutine_handle<> handle);
+
+  float m_tickRate;
+  std::uint64_t m_now{};
+  std::vector<std::vector<Timer>> m_wheel;
+  std::vector<Timer> m_overflow{}; // a revolution or more away, sorted into the wheel as it turns
+  std::vector<std::coroutine_handle<>> m_ready{};
+  std::vector<std::coroutine_handle<>> m_resuming{};
+  std::vector<std::coroutine_handle<Task::promise_type>> m_tasks{};
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+// Event trace written as Chrome trace_event JSON (chrome://tracing, Perfetto).
+// Events go into buffers preallocated per thread and are only written out by
+// write(). While tracing is off every call is a single, predictable branch
+class Trace
+{
+public:
+  struct Event
+  {
+    char const* name;
+    char phase; // 'X' complete, 'i' instant
+    std::int64_t start; // ns
+    std::int64_t duration;
+    int arg;
+  };
+
+  // enable before starting any thread that records. Each thread reserves
+  // eventsPerThread when it first records (about 5 MB by default) and drops
+  // events past it
+  static void enable(std::filesystem::path output, std::size_t eventsPerThread = 1 << 17);
+  static void write();
+  static void threadName(char const* name);
+
+  static void instant(char const* name, int arg = 0)
+  {
+    if(s_enabled) [[unlikely]] {
+      record(Event{name, 'i', now(), 0, arg});
+    }
+  }
+
+  // records the time between construction and destruction
+  class Scope
+  {
+  public:
+    Scope(char const* name, int arg = 0) :
+      m_name{name}, m_arg{arg}
+    {
+      if(s_enabled) [[unlikely]] {
+        m_start = now();
+      }
+    }
+    ~Scope()
+    {
+      if(s_enabled) [[unlikely]] {
+        record(Event{m_name, 'X', m_start, now() - m_start, m_arg});
+      }
+    }
+    Scope(Scope const&) = delete;
+    Scope& operator=(Scope const&) = delete;
+
+  private:
+    char const* m_name;
+    int m_arg;
+    std::int64_t m_start{};
+  };
+
+private:
+  static std::int64_t now();
+  static void record(Event const& event);
+
+  inline static bool s_enabled{false};
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Lock-free handoff between one writer and one reader. The writer fills back()
+// and publishes it, the reader picks up the latest published slot with update().
+// Neither side ever waits; slots the reader didn't get to are simply overwritten
+template<typename T>
+class TripleBuffer
+{
+public:
+  // writer
+  T& back() { return m_slots[m_back]; }
+  void publish()
+  {
+    unsigned previous = m_middle.exchange(m_back | Fresh, std::memory_order_acq_rel);
+    m_back = previous & Index;
+  }
+
+  // reader, returns false if nothing new was published since the last call
+  bool update()
+  {
+    if((m_middle.load(std::memory_order_relaxed) & Fresh) == 0) {
+      return false;
+    }
+    unsigned previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+    m_front = previous & Index;
+    return true;
+  }
+  T const& front() const { return m_slots[m_front]; }
+
+private:
+  static constexpr unsigned Index = 0b011;
+  static constexpr unsigned Fresh = 0b100;
+
+  std::array<T, 3> m_slots{};
+  alignas(64) std::atomic<unsigned> m_middle{1};
+  alignas(64) unsigned m_back{0};
+  alignas(64) unsigned m_front{2};
+};
@@ -36,7 +36,8 @@ struct std::hash<YX<T>>
 {
   std::size_t operator()(const YX<T>& s) const noexcept
   {
-    return s.y ^ (s.x << 1);
+    // spread y over the high bits so nearby keys don't collide
+    return std::hash<T>{}(s.y) * 0x9E3779B97F4A7C15ull ^ std::hash<T>{}(s.x);
   }
 };
 
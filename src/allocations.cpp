@@ -0,0 +1,54 @@
+#include "allocations.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+  std::atomic<std::uint64_t> allocationCount{0};
+  std::atomic<std::uint64_t> freeCount{0};
+
+  void* allocateNothrow(std::size_t size) noexcept
+  {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+  }
+
+  void* allocate(std::size_t size)
+  {
+    void* ptr = allocateNothrow(size);
+    if(ptr == nullptr) {
+      throw std::bad_alloc{};
+    }
+    return ptr;
+  }
+
+  void deallocate(void* ptr) noexcept
+  {
+    if(ptr != nullptr) {
+      freeCount.fetch_add(1, std::memory_order_relaxed);
+      std::free(ptr);
+    }
+  }
+}
+
+auto Allocations::count() -> Allocations
+{
+  return {
+    .allocations = allocationCount.load(std::memory_order_relaxed),
+    .frees = freeCount.load(std::memory_order_relaxed),
+  };
+}
+
+// over-aligned allocations keep the default operators, nothing here needs them
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept { return allocateNothrow(size); }
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept { return allocateNothrow(size); }
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::nothrow_t const&) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::nothrow_t const&) noexcept { deallocate(ptr); }
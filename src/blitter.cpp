@@ -0,0 +1,42 @@
+#include "blitter.hpp"
+
+#include <algorithm>
+
+void blitRowsGeneric(chtype* dst, int dstStride, char const* src, int srcStride, int rows, int width)
+{
+  for(int y{}; y < rows; ++y) {
+    for(int x{}; x < width; ++x) {
+      dst[y * dstStride + x] = static_cast<unsigned char>(src[y * srcStride + x]);
+    }
+  }
+}
+
+void blitSprite(Sprite const& sprite, YX<int> position, chtype* framebuffer, YX<int> framebufferSize)
+{
+  YX<int> size = sprite.size();
+
+  // visible part of the sprite, in sprite coordinates
+  YX<int> start{
+    .y = std::max(0, -position.y),
+    .x = std::max(0, -position.x),
+  };
+  YX<int> end{
+    .y = std::min(size.y, framebufferSize.y - position.y),
+    .x = std::min(size.x, framebufferSize.x - position.x),
+  };
+  if(start.y >= end.y || start.x >= end.x) {
+    return;
+  }
+
+  int rows = end.y - start.y;
+  int width = end.x - start.x;
+  chtype* dst = framebuffer + (position.y + start.y) * framebufferSize.x + position.x + start.x;
+  char const* src = sprite.row(start.y) + start.x;
+  int srcStride = size.x + 1;
+
+  if(width <= MaxUnrolledWidth) {
+    unrolledBlitters[width](dst, framebufferSize.x, src, srcStride, rows);
+  } else {
+    blitRowsGeneric(dst, framebufferSize.x, src, srcStride, rows, width);
+  }
+}
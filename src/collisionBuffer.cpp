@@ -1,18 +1,31 @@
 #include "collisionBuffer.hpp"
 
+#include "formation.hpp"
 #include "yx.hpp"
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 
-CollisionBuffer::CollisionBuffer(YX<int> gridSize, std::unordered_map<Entity::ID, Entity>& entities) :
+CollisionBuffer::CollisionBuffer(YX<int> gridSize, std::unordered_map<Entity::ID, Entity>& entities, Formation const& formation) :
   m_entities{entities},
-  m_gridSize{gridSize}
+  m_formation{formation},
+  m_collidersIDs{},
+  m_colliderIndex{},
+  m_gridSize{gridSize},
+  m_chunks{},
+  m_freeChunks{},
+  m_staleChunks{},
+  m_bands((gridSize.y + ChunkSize - 1) / ChunkSize),
+  m_visited{},
+  m_visit{}
 {
+  static_assert(CollisionBuffer::Empty == 0, "chunks are zero initialized");
 }
 
 void CollisionBuffer::add(Entity::ID id)
 {
+  m_colliderIndex.emplace(id, m_collidersIDs.size());
   m_collidersIDs.push_back(id);
 }
 
@@ -20,46 +33,204 @@ void CollisionBuffer::paint(YX<int> start, YX<int> end)
 {
   for(int y = start.y; y <= end.y; ++y) {
     for(int x = start.x; x <= end.x; ++x) {
-      m_cells.emplace(YX<int>{y, x}, CollisionBuffer::Invalid);
+      YX<int> pos{y, x};
+      if(!contains(pos)) {
+        continue;
+      }
+      Chunk& c = allocateChunk(pos);
+      Entity::ID& geometry = c.geometry[cellIndex(pos)];
+      if(geometry == CollisionBuffer::Empty) {
+        geometry = CollisionBuffer::Invalid;
+        c.solid += 1;
+      }
     }
   }
 }
 
 void CollisionBuffer::remove(Entity::ID id)
 {
-  m_collidersIDs.erase(std::find(m_collidersIDs.begin(), m_collidersIDs.end(), id));
+  // swap with the last collider so removal doesn't shift the whole list
+  auto it = m_colliderIndex.find(id);
+  std::size_t index = it->second;
+  m_colliderIndex.erase(it);
+
+  Entity::ID last = m_collidersIDs.back();
+  m_collidersIDs[index] = last;
+  m_collidersIDs.pop_back();
+  if(last != id) {
+    m_colliderIndex[last] = index;
+  }
 }
 
-void CollisionBuffer::update()
+void CollisionBuffer::update(ThreadPool& pool)
 {
-  m_cells.clear();
-  for(auto& e : m_collidersIDs) {
-    map_entity(e);
+  // chunks left empty since the last update are recycled
+  m_staleChunks.clear();
+  for(auto it = m_chunks.begin(); it != m_chunks.end();) {
+    Chunk& c = *it->second;
+    if(c.occupied == 0 && c.solid == 0) {
+      m_freeChunks.push_back(std::move(it->second));
+      it = m_chunks.erase(it);
+      continue;
+    }
+    if(c.occupied > 0) {
+      m_staleChunks.push_back(&c);
+    }
+    ++it;
+  }
+  pool.parallelFor(m_staleChunks.size(), 16, [this](std::size_t begin, std::size_t end) {
+    for(std::size_t i = begin; i < end; ++i) {
+      m_staleChunks[i]->cells.fill(CollisionBuffer::Empty);
+      m_staleChunks[i]->occupied = 0;
+    }
+  });
+
+  // chunks are created up front and colliders split by the rows of chunks they
+  // cover, so the tasks below never share a chunk. Within a row the colliders
+  // keep their order and the first one stamped still owns a shared cell
+  for(auto& band : m_bands) {
+    band.clear();
+  }
+
+  // every ID a query can find until the next update, formation members included
+  Entity::ID maxID = CollisionBuffer::Invalid;
+  for(auto& [id, entity] : m_entities) {
+    maxID = std::max(maxID, id);
+  }
+  if(static_cast<std::size_t>(maxID + 2) > m_visited.size()) {
+    m_visited.resize(std::max(static_cast<std::size_t>(maxID + 2), m_visited.size() * 2));
+  }
+
+  for(auto& id : m_collidersIDs) {
+    Entity& entity = m_entities.at(id);
+    YX<float> position = entity.worldPosition();
+    YX<int> start{static_cast<int>(position.y), static_cast<int>(position.x)};
+    YX<int> end{start.y + entity.sprite().size().y, start.x + entity.sprite().size().x};
+    start = {std::max(start.y, 0), std::max(start.x, 0)};
+    end = {std::min(end.y, m_gridSize.y), std::min(end.x, m_gridSize.x)};
+    if(start.y >= end.y || start.x >= end.x) {
+      continue;
+    }
+
+    for(int cy = start.y / ChunkSize; cy <= (end.y - 1) / ChunkSize; ++cy) {
+      for(int cx = start.x / ChunkSize; cx <= (end.x - 1) / ChunkSize; ++cx) {
+        allocateChunk(YX<int>{cy * ChunkSize, cx * ChunkSize});
+      }
+      m_bands[cy].push_back({
+        .id = id,
+        .start = {std::max(start.y, cy * ChunkSize), start.x},
+        .end = {std::min(end.y, (cy + 1) * ChunkSize), end.x},
+      });
+    }
   }
+  pool.dispatch(m_bands.size(), [this](std::size_t band) {
+    for(auto& s : m_bands[band]) {
+      stamp(s);
+    }
+  });
 }
 
-auto CollisionBuffer::at(YX<int> pos) -> Entity::ID
+auto CollisionBuffer::at(YX<int> pos) const -> Entity::ID
 {
-  return m_cells.contains(pos) ? m_cells.at(pos) : CollisionBuffer::Empty;
+  if(!contains(pos)) {
+    return CollisionBuffer::Invalid;
+  }
+
+  // colliders, then the formation under them, then the walls
+  Chunk* c = chunk(pos);
+  if(c != nullptr && c->cells[cellIndex(pos)] != CollisionBuffer::Empty) {
+    return c->cells[cellIndex(pos)];
+  }
+  Entity::ID member = m_formation.at(pos);
+  if(member != CollisionBuffer::Empty || c == nullptr) {
+    return member;
+  }
+  return c->geometry[cellIndex(pos)];
 }
 
-auto CollisionBuffer::at(YX<float> pos) -> Entity::ID
+auto CollisionBuffer::at(YX<float> pos) const -> Entity::ID
 {
   return at(YX<int>{static_cast<int>(pos.y), static_cast<int>(pos.x)});
 }
 
-auto CollisionBuffer::collides(Entity::ID id) -> std::vector<Entity::ID>
+void CollisionBuffer::row(YX<int> start, std::span<Entity::ID> out) const
 {
-  std::vector<Entity::ID> collisions;
-  for_each_cell(id, [&, this](YX<int> cell) {
-    if(m_cells.contains(cell)) {
-      collisions.push_back(m_cells.at(cell));
+  int end = start.x + static_cast<int>(out.size());
+  if(start.y < 0 || start.y >= m_gridSize.y) {
+    std::fill(out.begin(), out.end(), CollisionBuffer::Invalid);
+    return;
+  }
+
+  // colliders a chunk segment at a time
+  std::fill(out.begin(), out.end(), CollisionBuffer::Empty);
+  for(int x = std::max(start.x, 0); x < std::min(end, m_gridSize.x);) {
+    YX<int> pos{start.y, x};
+    int segmentEnd = std::min({(x / ChunkSize + 1) * ChunkSize, end, m_gridSize.x});
+    if(Chunk* c = chunk(pos); c != nullptr && c->occupied > 0) {
+      auto cells = c->cells.begin() + cellIndex(pos);
+      std::copy(cells, cells + (segmentEnd - x), out.begin() + (x - start.x));
     }
+    x = segmentEnd;
+  }
+
+  // then the formation and the walls fill what is left
+  m_formation.row(start, out);
+  for(int x = start.x; x < end;) {
+    YX<int> pos{start.y, x};
+    if(x < 0 || x >= m_gridSize.x) {
+      out[x - start.x] = CollisionBuffer::Invalid;
+      ++x;
+      continue;
+    }
+    int segmentEnd = std::min({(x / ChunkSize + 1) * ChunkSize, end, m_gridSize.x});
+    if(Chunk* c = chunk(pos); c != nullptr && c->solid > 0) {
+      auto geometry = c->geometry.begin() + cellIndex(pos);
+      for(int i{}; i < segmentEnd - x; ++i) {
+        auto& cell = out[x - start.x + i];
+        cell = cell != CollisionBuffer::Empty ? cell : geometry[i];
+      }
+    }
+    x = segmentEnd;
+  }
+}
+
+auto CollisionBuffer::query(YX<int> start, YX<int> end, std::span<Entity::ID> out) -> std::size_t
+{
+  std::size_t found{};
+  if(out.empty()) {
+    return found;
+  }
+  query(start, end, [&](Entity::ID id) {
+    out[found++] = id;
+    return found < out.size();
+  });
+  return found;
+}
+
+auto CollisionBuffer::collides(Entity::ID id, std::span<Entity::ID> out) -> std::size_t
+{
+  std::size_t found{};
+  if(out.empty()) {
+    return found;
+  }
+  collides(id, [&](Entity::ID hit) {
+    out[found++] = hit;
+    return found < out.size();
+  });
+  return found;
+}
+
+bool CollisionBuffer::blocked(Entity::ID id)
+{
+  bool found{};
+  collides(id, [&](Entity::ID) {
+    found = true;
+    return false;
   });
-  return collisions;
+  return found;
 }
 
-Entity::ID CollisionBuffer::raycast(YX<float> rayStart, YX<float> rayDir)
+Entity::ID CollisionBuffer::raycast(YX<float> rayStart, YX<float> rayDir) const
 {
   // Normalize
   rayDir.normalize();
@@ -73,7 +244,7 @@ Entity::ID CollisionBuffer::raycast(YX<float> rayStart, YX<float> rayDir)
     .y = static_cast<int>(rayStart.y),
     .x = static_cast<int>(rayStart.x),
   };
-  YX<int> rayLenght1D;
+  YX<float> rayLenght1D; // infinite along an axis the ray is parallel to
   YX<int> step;
   Entity::ID collision = CollisionBuffer::Empty;
 
@@ -115,15 +286,10 @@ Entity::ID CollisionBuffer::raycast(YX<float> rayStart, YX<float> rayDir)
        mapCheck.y >= 0 &&
        mapCheck.y < m_gridSize.y) {
       // Check for collisions
-      YX<int> pos{
-        .y = mapCheck.y * m_gridSize.x,
-        .x = mapCheck.x,
-      };
-      if(m_cells.contains(pos)) {
-        if(m_cells.at(pos) != CollisionBuffer::Empty) {
-          tileFound = true;
-          collision = m_cells.at(pos);
-        }
+      Entity::ID hit = at(mapCheck);
+      if(hit != CollisionBuffer::Empty) {
+        tileFound = true;
+        collision = hit;
       }
     }
 
@@ -137,27 +303,80 @@ Entity::ID CollisionBuffer::raycast(YX<float> rayStart, YX<float> rayDir)
 
 ////////
 
-void CollisionBuffer::for_each_cell(Entity::ID id, std::function<void(YX<int>)> fun)
+bool CollisionBuffer::contains(YX<int> pos) const
 {
-  Entity& entity = m_entities.at(id);
-  Sprite& sprite = m_entities.at(id).sprite();
-
-  for(int y = 0; y < sprite.size().y; ++y) {
-    for(int x = 0; x < sprite.size().x; ++x) {
-      auto key = YX<int>{
-        .y = y + static_cast<int>(entity.position().y),
-        .x = x + static_cast<int>(entity.position().x)};
-      fun(key);
+  return pos.y >= 0 && pos.y < m_gridSize.y && pos.x >= 0 && pos.x < m_gridSize.x;
+}
+
+auto CollisionBuffer::chunk(YX<int> pos) const -> Chunk*
+{
+  auto it = m_chunks.find(YX<int>{pos.y / ChunkSize, pos.x / ChunkSize});
+  return it != m_chunks.end() ? it->second.get() : nullptr;
+}
+
+auto CollisionBuffer::allocateChunk(YX<int> pos) -> Chunk&
+{
+  auto& slot = m_chunks[YX<int>{pos.y / ChunkSize, pos.x / ChunkSize}];
+  if(slot == nullptr) {
+    if(m_freeChunks.empty()) {
+      slot = std::make_unique<Chunk>();
+    } else {
+      // recycled chunks are already cleared
+      slot = std::move(m_freeChunks.back());
+      m_freeChunks.pop_back();
     }
   }
+  return *slot;
 }
 
-void CollisionBuffer::unmap_entity(Entity::ID id)
+int CollisionBuffer::cellIndex(YX<int> pos)
 {
-  for_each_cell(id, [this](YX<int> cell) { m_cells.erase(cell); });
+  return (pos.y % ChunkSize) * ChunkSize + pos.x % ChunkSize;
 }
 
-void CollisionBuffer::map_entity(Entity::ID id)
+void CollisionBuffer::stamp(Stamp const& stamp)
 {
-  for_each_cell(id, [this, id](YX<int> cell) { m_cells.emplace(cell, id); });
+  for(int y = stamp.start.y; y < stamp.end.y; ++y) {
+    for(int x = stamp.start.x; x < stamp.end.x;) {
+      YX<int> pos{y, x};
+      int segmentEnd = std::min((x / ChunkSize + 1) * ChunkSize, stamp.end.x);
+      Chunk& c = *chunk(pos);
+      for(int i = cellIndex(pos); x < segmentEnd; ++x, ++i) {
+        if(c.cells[i] == CollisionBuffer::Empty) {
+          c.cells[i] = stamp.id;
+          c.occupied += 1;
+        }
+      }
+    }
+  }
+}
+
+auto CollisionBuffer::box(Entity::ID id) const -> std::array<YX<int>, 2>
+{
+  Entity& entity = m_entities.at(id);
+  YX<float> position = entity.worldPosition();
+  YX<int> start{static_cast<int>(position.y), static_cast<int>(position.x)};
+  return {start, YX<int>{start.y + entity.sprite().size().y, start.x + entity.sprite().size().x}};
+}
+
+void CollisionBuffer::beginVisit()
+{
+  m_visit += 1;
+  if(m_visit == 0) {
+    // wrapped around, older marks could be mistaken for this query
+    std::fill(m_visited.begin(), m_visited.end(), 0);
+    m_visit = 1;
+  }
+}
+
+bool CollisionBuffer::firstVisit(Entity::ID id)
+{
+  // sized by update() for every ID in the grid
+  auto index = static_cast<std::size_t>(id + 1);
+  assert(index < m_visited.size() && "ID newer than the last update");
+  if(m_visited[index] == m_visit) {
+    return false;
+  }
+  m_visited[index] = m_visit;
+  return true;
 }
@@ -0,0 +1,124 @@
+#include "compositor.hpp"
+
+#include <algorithm>
+
+void Compositor::resize(YX<int> screen)
+{
+  // nothing composes to Transparent, so every cell is written once
+  m_screen.resize(screen);
+  m_screen.clear(Transparent);
+  m_dirty.clear();
+  markScreenDirty({{0, 0}, screen});
+}
+
+void Compositor::place(Layer layer, Framebuffer const* cells, YX<int> origin)
+{
+  auto& entry = m_layers[static_cast<std::size_t>(layer)];
+  if(entry.cells != nullptr) {
+    markDirty(layer);
+  }
+  entry.cells = cells;
+  entry.origin = origin;
+  markDirty(layer);
+}
+
+void Compositor::show(Layer layer, bool visible)
+{
+  auto& entry = m_layers[static_cast<std::size_t>(layer)];
+  if(entry.visible != visible) {
+    entry.visible = visible;
+    markDirty(layer);
+  }
+}
+
+void Compositor::markDirty(Layer layer, Rect rect)
+{
+  auto& entry = m_layers[static_cast<std::size_t>(layer)];
+  markScreenDirty({
+    {rect.start.y + entry.origin.y, rect.start.x + entry.origin.x},
+    {rect.end.y + entry.origin.y, rect.end.x + entry.origin.x},
+  });
+}
+
+void Compositor::markDirty(Layer layer)
+{
+  auto& entry = m_layers[static_cast<std::size_t>(layer)];
+  if(entry.cells != nullptr) {
+    markDirty(layer, {{0, 0}, entry.cells->size()});
+  }
+}
+
+void Compositor::present()
+{
+  bool changed = false;
+  for(auto& rect : m_dirty) {
+    for(int y = rect.start.y; y < rect.end.y; ++y) {
+      auto row = m_screen.row(y);
+      // changed cells are written in runs
+      int run = -1;
+      for(int x = rect.start.x; x <= rect.end.x; ++x) {
+        bool differs = false;
+        if(x < rect.end.x) {
+          chtype cell = compose(YX<int>{y, x});
+          differs = cell != row[x];
+          if(differs) {
+            m_screen.set(YX<int>{y, x}, cell);
+          }
+        }
+        if(differs && run < 0) {
+          run = x;
+        } else if(!differs && run >= 0) {
+          mvaddchnstr(y, run, row.data() + run, x - run);
+          if(m_recorder != nullptr) {
+            m_recorder->cells({y, run}, row.subspan(run, x - run));
+          }
+          changed = true;
+          run = -1;
+        }
+      }
+    }
+  }
+  m_dirty.clear();
+
+  if(m_recorder != nullptr) {
+    if(m_recorder->keyframe()) {
+      for(int y{}; y < m_screen.size().y; ++y) {
+        m_recorder->cells({y, 0}, m_screen.row(y));
+      }
+    }
+    m_recorder->endFrame();
+  }
+
+  if(changed) {
+    refresh();
+  }
+}
+
+////////
+
+auto Compositor::compose(YX<int> pos) const -> chtype
+{
+  for(auto layer = m_layers.rbegin(); layer != m_layers.rend(); ++layer) {
+    if(layer->cells == nullptr || !layer->visible) {
+      continue;
+    }
+    YX<int> local{pos.y - layer->origin.y, pos.x - layer->origin.x};
+    if(layer->cells->contains(local)) {
+      chtype cell = layer->cells->at(local);
+      if(cell != Transparent) {
+        return cell;
+      }
+    }
+  }
+  return ' ';
+}
+
+void Compositor::markScreenDirty(Rect rect)
+{
+  YX<int> screen = m_screen.size();
+  rect.start = {std::max(rect.start.y, 0), std::max(rect.start.x, 0)};
+  rect.end = {std::min(rect.end.y, screen.y), std::min(rect.end.x, screen.x)};
+  if(rect.start.y < rect.end.y && rect.start.x < rect.end.x) {
+    m_dirty.push_back(rect);
+  }
+}
@@ -0,0 +1,130 @@
+#include "config.hpp"
+
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+  std::string trim(std::string const& str)
+  {
+    auto begin = str.find_first_not_of(" \t\r");
+    if(begin == std::string::npos) {
+      return {};
+    }
+    auto end = str.find_last_not_of(" \t\r");
+    return str.substr(begin, end - begin + 1);
+  }
+
+  template<typename T>
+  void parse(std::istringstream& value, T& out)
+  {
+    value >> out;
+  }
+
+  template<typename T>
+  void parse(std::istringstream& value, YX<T>& out)
+  {
+    value >> out.y >> out.x;
+  }
+
+  template<typename T>
+  auto setter(T& field) -> std::function<bool(std::istringstream&)>
+  {
+    return [&field](std::istringstream& value) {
+      T parsed{};
+      parse(value, parsed);
+      if(value.fail() || !(value >> std::ws).eof()) {
+        return false;
+      }
+      field = parsed;
+      return true;
+    };
+  }
+}
+
+auto Config::load(std::filesystem::path path) -> Config
+{
+  std::ifstream file{path};
+  if(!file.is_open()) {
+    throw std::runtime_error("Failed to load " + path.string() + " level");
+  }
+
+  Config config{};
+  std::unordered_map<std::string, std::function<bool(std::istringstream&)>> keys{
+    {"sim.tick_rate", setter(config.tickRate)},
+    {"render.frame_rate", setter(config.frameRate)},
+    {"sim.threads", setter(config.threads)},
+    {"arena.size", setter(config.arenaSize)},
+    {"formation.size", setter(config.alienFormation)},
+    {"formation.start", setter(config.alienStartingPoint)},
+    {"formation.spacing", setter(config.alienSpacing)},
+    {"alien.speed", setter(config.alienSpeed)},
+    {"alien.speedup", setter(config.alienSpeedup)},
+    {"alien.sway", setter(config.alienSway)},
+    {"alien.fire_interval", setter(config.alienFireInterval)},
+    {"alien.fire_min_interval", setter(config.alienFireMinInterval)},
+    {"ship.health", setter(config.shipHealth)},
+    {"ship.step", setter(config.shipStep)},
+    {"ship.bullet_speed", setter(config.shipBulletSpeed)},
+    {"ship.fire_interval", setter(config.shipFireInterval)},
+  };
+
+  std::string line;
+  for(int lineNum{1}; std::getline(file, line); ++lineNum) {
+    auto where = path.string() + ":" + std::to_string(lineNum) + ": ";
+
+    line = trim(line.substr(0, line.find('#')));
+    if(line.empty()) {
+      continue;
+    }
+
+    auto separator = line.find('=');
+    if(separator == std::string::npos) {
+      throw std::runtime_error(where + "expected 'key = value'");
+    }
+
+    auto key = trim(line.substr(0, separator));
+    auto it = keys.find(key);
+    if(it == keys.end()) {
+      throw std::runtime_error(where + "unknown key '" + key + "'");
+    }
+
+    std::istringstream value{trim(line.substr(separator + 1))};
+    if(!it->second(value)) {
+      throw std::runtime_error(where + "invalid value for '" + key + "'");
+    }
+  }
+
+  config.validate();
+  return config;
+}
+
+void Config::validate() const
+{
+  auto check = [](bool condition, char const* message) {
+    if(!condition) {
+      throw std::runtime_error(std::string{"Invalid level: "} + message);
+    }
+  };
+
+  check(tickRate > 0 && tickRate <= 1000, "sim.tick_rate must be between 0 and 1000");
+  check(frameRate > 0 && frameRate <= 1000, "render.frame_rate must be between 0 and 1000");
+  check(threads >= 0 && threads <= maxThreads, "sim.threads must be between 0 and 256");
+  check(arenaSize.y >= minArenaSize.y && arenaSize.x >= minArenaSize.x, "arena.size is too small");
+  check(arenaSize.y <= maxArenaSize.y && arenaSize.x <= maxArenaSize.x, "arena.size is too large");
+  check(alienFormation.y > 0 && alienFormation.x > 0, "formation.size must be positive");
+  check(static_cast<long>(alienFormation.y) * alienFormation.x <= maxAliens, "formation.size has too many aliens");
+  check(alienStartingPoint.y > 0 && alienStartingPoint.x > 0, "formation.start must be inside the arena");
+  check(alienSpacing.y >= 0 && alienSpacing.x >= 0, "formation.spacing can't be negative");
+  check(alienSpeed > 0, "alien.speed must be positive");
+  check(alienSpeedup >= 0, "alien.speedup can't be negative");
+  check(alienSway >= 0, "alien.sway can't be negative");
+  check(alienFireInterval >= 0 && alienFireMinInterval > 0, "alien fire intervals must be positive");
+  check(shipHealth > 0, "ship.health must be positive");
+  check(shipStep > 0 && shipBulletSpeed > 0, "ship.step and ship.bullet_speed must be positive");
+  check(shipFireInterval >= 0, "ship.fire_interval can't be negative");
+}
@@ -17,12 +17,14 @@ Entity::Entity(Entity&& other) :
   m_id{other.m_id},
   m_position{other.m_position},
   m_velocity{other.m_velocity},
+  m_anchor{other.m_anchor},
   m_health{other.m_health},
   m_sprite{std::move(other.m_sprite)}
 {
   other.m_id = {-1};
   other.m_position = {};
   other.m_velocity = {};
+  other.m_anchor = nullptr;
   other.m_health = {};
   other.m_sprite = nullptr;
 }
@@ -0,0 +1,139 @@
+#include "formation.hpp"
+
+#include "collisionBuffer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+Formation::Formation(int columns) :
+  m_columns(columns),
+  m_liveIndex(columns, -1)
+{
+}
+
+void Formation::place(YX<float> origin, YX<int> extent)
+{
+  m_origin = origin;
+  m_extent = extent;
+  m_cells.assign(extent.y * extent.x, CollisionBuffer::Empty);
+}
+
+void Formation::add(int column, Entity::ID id, YX<int> offset, YX<int> size)
+{
+  assert(column >= 0 && column < static_cast<int>(m_columns.size()));
+  assert(offset.y + size.y <= m_extent.y && offset.x + size.x <= m_extent.x);
+
+  if(m_columns[column].empty()) {
+    m_liveIndex[column] = m_liveColumns.size();
+    m_liveColumns.push_back(column);
+  }
+  m_columns[column].push_back(id);
+
+  Member member{column, offset, size};
+  stamp(member, id);
+  m_members.emplace(id, member);
+}
+
+void Formation::remove(Entity::ID id)
+{
+  auto it = m_members.find(id);
+  if(it == m_members.end()) {
+    return;
+  }
+
+  Member member = it->second;
+  m_members.erase(it);
+  stamp(member, CollisionBuffer::Empty);
+
+  auto& members = m_columns[member.column];
+  members.erase(std::find(members.begin(), members.end(), id));
+  if(members.empty()) {
+    retireColumn(member.column);
+  }
+}
+
+auto Formation::at(YX<int> pos) const -> Entity::ID
+{
+  // the stamp shifts by whole cells as the origin moves
+  YX<int> local{
+    .y = pos.y - static_cast<int>(std::floor(m_origin.y)),
+    .x = pos.x - static_cast<int>(std::floor(m_origin.x)),
+  };
+  if(local.y < 0 || local.y >= m_extent.y || local.x < 0 || local.x >= m_extent.x) {
+    return CollisionBuffer::Empty;
+  }
+  return m_cells[local.y * m_extent.x + local.x];
+}
+
+void Formation::row(YX<int> start, std::span<Entity::ID> out) const
+{
+  YX<int> local{
+    .y = start.y - static_cast<int>(std::floor(m_origin.y)),
+    .x = start.x - static_cast<int>(std::floor(m_origin.x)),
+  };
+  if(local.y < 0 || local.y >= m_extent.y) {
+    return;
+  }
+
+  int from = std::max(local.x, 0);
+  int to = std::min(local.x + static_cast<int>(out.size()), m_extent.x);
+  auto cells = m_cells.begin() + local.y * m_extent.x;
+  for(int x = from; x < to; ++x) {
+    auto& cell = out[x - local.x];
+    cell = cell != CollisionBuffer::Empty ? cell : cells[x];
+  }
+}
+
+void Formation::forEachMember(YX<int> start, YX<int> end, std::function<void(Entity::ID)> fun) const
+{
+  YX<int> origin{static_cast<int>(std::floor(m_origin.y)), static_cast<int>(std::floor(m_origin.x))};
+  YX<int> from{std::max(start.y - origin.y, 0), std::max(start.x - origin.x, 0)};
+  YX<int> to{std::min(end.y - origin.y, m_extent.y), std::min(end.x - origin.x, m_extent.x)};
+
+  // members are rectangles, so each is reported at the first of its cells inside the window
+  for(int y = from.y; y < to.y; ++y) {
+    for(int x = from.x; x < to.x; ++x) {
+      Entity::ID id = m_cells[y * m_extent.x + x];
+      if(id == CollisionBuffer::Empty) {
+        continue;
+      }
+      bool first = (x == from.x || m_cells[y * m_extent.x + x - 1] != id) &&
+                   (y == from.y || m_cells[(y - 1) * m_extent.x + x] != id);
+      if(first) {
+        fun(id);
+      }
+    }
+  }
+}
+
+auto Formation::shooter(std::mt19937& random) -> std::optional<Entity::ID>
+{
+  if(m_liveColumns.empty()) {
+    return std::nullopt;
+  }
+
+  int column = m_liveColumns[random() % m_liveColumns.size()];
+  return m_columns[column].back();
+}
+
+////////
+
+void Formation::stamp(Member const& member, Entity::ID id)
+{
+  for(int y = 0; y < member.size.y; ++y) {
+    auto row = m_cells.begin() + (member.offset.y + y) * m_extent.x + member.offset.x;
+    std::fill(row, row + member.size.x, id);
+  }
+}
+
+void Formation::retireColumn(int column)
+{
+  // swap with the last live column so the list stays packed
+  int index = m_liveIndex[column];
+  int last = m_liveColumns.back();
+  m_liveColumns[index] = last;
+  m_liveIndex[last] = index;
+  m_liveColumns.pop_back();
+  m_liveIndex[column] = -1;
+}
@@ -0,0 +1,60 @@
+#include "frameScheduler.hpp"
+
+#include <algorithm>
+#include <thread>
+
+FrameScheduler::FrameScheduler(float rate) :
+  m_period{std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.f / rate))},
+  m_deadline{Clock::now() + m_period},
+  m_previous{Clock::now()}
+{
+}
+
+auto FrameScheduler::wait() -> float
+{
+  using Seconds = std::chrono::duration<float>;
+  auto now = Clock::now();
+
+  float work = Seconds(now - m_previous).count();
+  m_budget.work += (work - m_budget.work) * 0.1f;
+  m_budget.load = m_budget.work / Seconds(m_period).count();
+
+  if(now > m_deadline) {
+    m_budget.overruns += 1;
+    m_budget.worstOverrun = std::max(m_budget.worstOverrun, Seconds(now - m_deadline).count());
+    // more than a period behind, catching up would only burst frames
+    if(now - m_deadline > m_period) {
+      m_deadline = now;
+    }
+  } else {
+    sleepUntil(m_deadline);
+  }
+
+  now = Clock::now();
+  float elapsed = Seconds(now - m_previous).count();
+  m_previous = now;
+  m_deadline += m_period;
+  return elapsed;
+}
+
+////////
+
+void FrameScheduler::sleepUntil(Clock::time_point deadline)
+{
+  constexpr Clock::duration minMargin = std::chrono::microseconds(50);
+  constexpr Clock::duration maxMargin = std::chrono::milliseconds(4);
+
+  auto wakeTarget = deadline - m_spinMargin;
+  if(Clock::now() < wakeTarget) {
+    std::this_thread::sleep_until(wakeTarget);
+
+    // track the oversleep so the next sleep leaves enough room to spin
+    auto oversleep = Clock::now() - wakeTarget;
+    m_spinMargin += (oversleep * 2 - m_spinMargin) / 8;
+    m_spinMargin = std::clamp(m_spinMargin, minMargin, maxMargin);
+  }
+
+  while(Clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+}
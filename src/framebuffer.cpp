@@ -0,0 +1,71 @@
+#include "framebuffer.hpp"
+
+#include "blitter.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+Framebuffer::Framebuffer(YX<int> size)
+{
+  resize(size);
+}
+
+void Framebuffer::resize(YX<int> size)
+{
+  m_size = size;
+  m_cells.assign(size.y * size.x, ' ');
+}
+
+bool Framebuffer::contains(YX<int> pos) const
+{
+  return pos.y >= 0 && pos.y < m_size.y && pos.x >= 0 && pos.x < m_size.x;
+}
+
+bool Framebuffer::overlaps(YX<int> pos, YX<int> size) const
+{
+  return pos.y < m_size.y && pos.x < m_size.x && pos.y + size.y > 0 && pos.x + size.x > 0;
+}
+
+void Framebuffer::clear(chtype fill)
+{
+  std::fill(m_cells.begin(), m_cells.end(), fill);
+}
+
+void Framebuffer::set(YX<int> pos, chtype cell)
+{
+  if(contains(pos)) {
+    m_cells[pos.y * m_size.x + pos.x] = cell;
+  }
+}
+
+void Framebuffer::fill(YX<int> start, YX<int> end, chtype cell)
+{
+  for(int y = std::max(start.y, 0); y < std::min(end.y, m_size.y); ++y) {
+    for(int x = std::max(start.x, 0); x < std::min(end.x, m_size.x); ++x) {
+      m_cells[y * m_size.x + x] = cell;
+    }
+  }
+}
+
+void Framebuffer::print(YX<int> pos, std::string_view text, chtype attributes)
+{
+  for(std::size_t i{}; i < text.size(); ++i) {
+    set(YX<int>{pos.y, pos.x + static_cast<int>(i)}, static_cast<unsigned char>(text[i]) | attributes);
+  }
+}
+
+auto Framebuffer::at(YX<int> pos) const -> chtype
+{
+  return contains(pos) ? m_cells[pos.y * m_size.x + pos.x] : ' ';
+}
+
+auto Framebuffer::row(int y) const -> std::span<chtype const>
+{
+  assert(y >= 0 && y < m_size.y);
+  return {m_cells.data() + y * m_size.x, static_cast<std::size_t>(m_size.x)};
+}
+
+void Framebuffer::blit(Sprite const& sprite, YX<int> pos)
+{
+  blitSprite(sprite, pos, m_cells.data(), m_size);
+}
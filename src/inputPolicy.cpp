@@ -0,0 +1,79 @@
+#include "inputPolicy.hpp"
+
+#include <cmath>
+#include <limits>
+#include <optional>
+
+void KeyboardPolicy::poll(View const&, std::vector<Event>& events)
+{
+  for(auto event = m_reader.pop(); event; event = m_reader.pop()) {
+    events.push_back(*event);
+  }
+}
+
+void RandomPolicy::poll(View const& view, std::vector<Event>& events)
+{
+  // about one key every other tick
+  static constexpr int keys[]{';', 'j', ' '};
+  std::uniform_int_distribution<int> pick{0, 5};
+  int n = pick(m_random);
+  if(n < 3) {
+    events.push_back({keys[n], view.now});
+  }
+}
+
+void SpamFirePolicy::poll(View const& view, std::vector<Event>& events)
+{
+  events.push_back({' ', view.now});
+}
+
+void DodgeAndShootPolicy::poll(View const& view, std::vector<Event>& events)
+{
+  YX<float> shipPos = view.ship.position();
+  YX<int> shipSize = view.ship.sprite().size();
+  float shipCenter = shipPos.x + shipSize.x / 2.f;
+
+  // the alien bullet landing first near the ship, where it lands
+  std::optional<float> threat{};
+  float threatTime = Horizon;
+  for(auto id : view.bullets) {
+    auto& bullet = view.entities.at(id);
+    YX<float> velocity = bullet.velocity();
+    if(velocity.y >= 0) {
+      continue; // going up, fired by the ship
+    }
+    float time = (shipPos.y - bullet.position().y) / -velocity.y;
+    if(time < 0 || time >= threatTime) {
+      continue;
+    }
+    float landing = bullet.position().x + velocity.x * time;
+    if(landing >= shipPos.x - Margin && landing < shipPos.x + shipSize.x + Margin) {
+      threat = landing;
+      threatTime = time;
+    }
+  }
+
+  if(threat) {
+    events.push_back({*threat < shipCenter ? ';' : 'j', view.now});
+  } else {
+    float target = shipCenter;
+    float distance = std::numeric_limits<float>::max();
+    for(auto id : view.aliens) {
+      auto& alien = view.entities.at(id);
+      float center = alien.worldPosition().x + alien.sprite().size().x / 2.f;
+      if(std::fabs(center - shipCenter) < distance) {
+        distance = std::fabs(center - shipCenter);
+        target = center;
+      }
+    }
+    if(distance > view.config.shipStep) {
+      events.push_back({target > shipCenter ? ';' : 'j', view.now});
+    }
+  }
+
+  // anything but a wall above the gun is worth a shot
+  Entity::ID hit = view.collisions.raycast(YX<float>{shipPos.y - 1, shipCenter}, YX<float>{-1, 0});
+  if(hit != CollisionBuffer::Empty && hit != CollisionBuffer::Invalid) {
+    events.push_back({' ', view.now});
+  }
+}
@@ -0,0 +1,88 @@
+#include "inputReader.hpp"
+
+#include <cerrno>
+#include <poll.h>
+#include <stdexcept>
+#include <unistd.h>
+
+InputReader::InputReader()
+{
+  if(pipe(m_wakeup) != 0) {
+    throw std::runtime_error("Failed to create the input wakeup pipe");
+  }
+}
+
+InputReader::~InputReader()
+{
+  stop();
+  close(m_wakeup[0]);
+  close(m_wakeup[1]);
+}
+
+void InputReader::start()
+{
+  m_thread = std::jthread{[this](std::stop_token stop) { read(stop); }};
+}
+
+void InputReader::stop()
+{
+  if(!m_thread.joinable()) {
+    return;
+  }
+
+  m_thread.request_stop();
+  char byte{};
+  [[maybe_unused]] auto written = write(m_wakeup[1], &byte, 1);
+  m_thread.join();
+
+  // drain the wakeup so the reader can be started again
+  [[maybe_unused]] auto drained = ::read(m_wakeup[0], &byte, 1);
+}
+
+auto InputReader::pop() -> std::optional<Event>
+{
+  return m_events.pop();
+}
+
+////////
+
+void InputReader::read(std::stop_token stop)
+{
+  pollfd fds[2]{
+    {.fd = STDIN_FILENO, .events = POLLIN, .revents = 0},
+    {.fd = m_wakeup[0], .events = POLLIN, .revents = 0},
+  };
+  unsigned char buffer[64];
+
+  while(!stop.stop_requested()) {
+    if(poll(fds, 2, -1) < 0) {
+      if(errno == EINTR) {
+        continue; // interrupted by a signal
+      }
+      break;
+    }
+    if(fds[1].revents != 0) {
+      break;
+    }
+    if((fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0 && (fds[0].revents & POLLIN) == 0) {
+      break;
+    }
+
+    auto count = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+    if(count == 0) {
+      break; // stdin was closed
+    }
+    if(count < 0) {
+      if(errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      break;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    for(decltype(count) i{}; i < count; ++i) {
+      // if the simulation falls that far behind, the newest keys are dropped
+      m_events.push(Event{buffer[i], now});
+    }
+  }
+}
@@ -1,4 +1,6 @@
 #include "program.hpp"
+#include "scenario.hpp"
+#include "trace.hpp"
 
 #include <iostream>
 
@@ -18,17 +20,56 @@ std::filesystem::path get_sprite_path()
   return path;
 }
 
-int main()
+// the level file is optional, the built-in defaults are used without it
+Config get_config()
+{
+  char const* char_path = std::getenv("INVADERS_LEVEL_PATH");
+  if(char_path == nullptr) {
+    Config config{};
+    config.validate();
+    return config;
+  }
+
+  auto path = std::filesystem::path{char_path};
+
+  if(!std::filesystem::exists(path)) {
+    throw std::runtime_error("Level path does not exist!");
+  }
+
+  return Config::load(path);
+}
+
+int main(int argc, char** argv)
 {
   // sprites
   try {
     auto path = get_sprite_path();
-    auto program = Program{path};
+    if(char const* trace_path = std::getenv("INVADERS_TRACE_PATH"); trace_path != nullptr) {
+      Trace::enable(trace_path);
+    }
+
+    // --bench [filter] plays the built-in scenarios headless
+    if(argc > 1 && std::string_view{argv[1]} == "--bench") {
+      runScenarios(path, argc > 2 ? argv[2] : "", std::cout);
+      Trace::write();
+      return EXIT_SUCCESS;
+    }
+
+    auto config = get_config();
+    auto program = Program{path, config};
+    if(char const* metrics_path = std::getenv("INVADERS_METRICS_SOCKET"); metrics_path != nullptr) {
+      program.enableMetrics(metrics_path);
+    }
+    if(char const* record_path = std::getenv("INVADERS_RECORD_PATH"); record_path != nullptr) {
+      program.enableRecording(record_path);
+    }
     program.run();
   }
   catch(std::exception& e) {
+    Trace::write();
     std::cerr << e.what() << '.' << std::endl;
     return EXIT_FAILURE;
   }
+  Trace::write();
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,122 @@
+#include "metrics.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+auto Metrics::format() const -> std::string
+{
+  char line[512];
+  std::snprintf(line,
+    sizeof(line),
+    "tick=%llu entities=%i aliens=%i bullets=%i chunks=%i tick_ms=%.3f tick_overruns=%i "
+    "frame_ms=%.3f frame_overruns=%i allocs=%llu frees=%llu\n",
+    static_cast<unsigned long long>(tick),
+    entities,
+    aliens,
+    bullets,
+    collisionChunks,
+    tickTime * 1000,
+    tickOverruns,
+    frameTime * 1000,
+    frameOverruns,
+    static_cast<unsigned long long>(allocations),
+    static_cast<unsigned long long>(frees));
+  return line;
+}
+
+MetricsPublisher::MetricsPublisher(std::filesystem::path socketPath) :
+  m_socketPath{socketPath}
+{
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if(m_socketPath.string().size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("Metrics socket path is too long");
+  }
+  std::strcpy(address.sun_path, m_socketPath.c_str());
+
+  m_listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if(m_listener < 0) {
+    throw std::runtime_error("Failed to create the metrics socket");
+  }
+
+  // a socket left behind by a previous run would make bind() fail, anything
+  // else at the path is not ours to remove
+  struct stat existing{};
+  if(lstat(m_socketPath.c_str(), &existing) == 0) {
+    if(!S_ISSOCK(existing.st_mode)) {
+      close(m_listener);
+      throw std::runtime_error("Metrics socket path " + m_socketPath.string() + " exists and is not a socket");
+    }
+    unlink(m_socketPath.c_str());
+  }
+  if(bind(m_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(m_listener, 8) != 0) {
+    close(m_listener);
+    throw std::runtime_error("Failed to bind the metrics socket " + m_socketPath.string());
+  }
+
+  m_thread = std::jthread{[this](std::stop_token stop) { serve(stop); }};
+}
+
+MetricsPublisher::~MetricsPublisher()
+{
+  m_thread.request_stop();
+  m_thread.join();
+
+  for(int client : m_clients) {
+    close(client);
+  }
+  close(m_listener);
+  unlink(m_socketPath.c_str());
+}
+
+void MetricsPublisher::publish(Metrics const& metrics)
+{
+  m_metrics.back() = metrics;
+  m_metrics.publish();
+}
+
+////////
+
+void MetricsPublisher::serve(std::stop_token stop)
+{
+  constexpr int interval = 200; // ms
+
+  while(!stop.stop_requested()) {
+    pollfd listener{.fd = m_listener, .events = POLLIN, .revents = 0};
+    poll(&listener, 1, interval);
+    acceptClients();
+
+    if(!m_clients.empty() && m_metrics.update()) {
+      send(m_metrics.front().format());
+    }
+  }
+}
+
+void MetricsPublisher::acceptClients()
+{
+  for(int client = accept4(m_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC); client >= 0;
+      client = accept4(m_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) {
+    m_clients.push_back(client);
+  }
+}
+
+void MetricsPublisher::send(std::string const& line)
+{
+  std::erase_if(m_clients, [&](int client) {
+    auto sent = ::send(client, line.data(), line.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+    if(sent == static_cast<ssize_t>(line.size())) {
+      return false;
+    }
+    // a client that can't keep up or went away is dropped
+    close(client);
+    return true;
+  });
+}
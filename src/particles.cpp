@@ -0,0 +1,64 @@
+#include "particles.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+Particles::Particles(std::uint32_t seed) :
+  m_y(Capacity),
+  m_x(Capacity),
+  m_vy(Capacity),
+  m_vx(Capacity),
+  m_life(Capacity),
+  m_random{seed}
+{
+}
+
+void Particles::burst(YX<float> position, int count, float speed, float life)
+{
+  std::uniform_real_distribution<float> angle{0, 2 * std::numbers::pi_v<float>};
+  std::uniform_real_distribution<float> spread{0.5f, 1.f};
+
+  auto end = std::min(Capacity, m_count + static_cast<std::size_t>(std::max(count, 0)));
+  for(; m_count < end; ++m_count) {
+    float a = angle(m_random);
+    float s = speed * spread(m_random);
+    m_y[m_count] = position.y;
+    m_x[m_count] = position.x;
+    m_vy[m_count] = std::sin(a) * s;
+    m_vx[m_count] = std::cos(a) * s * 2; // cells are about twice as tall as they are wide
+    m_life[m_count] = life * spread(m_random);
+  }
+}
+
+void Particles::update(float timeStep)
+{
+  float drag = std::max(0.f, 1.f - Drag * timeStep);
+  float* y = m_y.data();
+  float* x = m_x.data();
+  float* vy = m_vy.data();
+  float* vx = m_vx.data();
+  float* life = m_life.data();
+  std::size_t count = m_count;
+  for(std::size_t i{}; i < count; ++i) {
+    y[i] += vy[i] * timeStep;
+    x[i] += vx[i] * timeStep;
+    vy[i] *= drag;
+    vx[i] *= drag;
+    life[i] -= timeStep;
+  }
+
+  // the dead are replaced by the last ones alive
+  for(std::size_t i{}; i < m_count;) {
+    if(life[i] > 0) {
+      ++i;
+      continue;
+    }
+    m_count -= 1;
+    y[i] = y[m_count];
+    x[i] = x[m_count];
+    vy[i] = vy[m_count];
+    vx[i] = vx[m_count];
+    life[i] = life[m_count];
+  }
+}
@@ -1,57 +1,23 @@
 #include "program.hpp"
 
+#include "allocations.hpp"
+#include "trace.hpp"
+
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <thread>
 
-Program::Program(std::filesystem::path sprites_path)
+Program::Program(std::filesystem::path sprites_path, Config config) :
+  m_config{config}
 {
   m_random.seed(std::chrono::steady_clock::now().time_since_epoch().count());
 
-  initCurses();
-  createWindows();
   loadSprites(sprites_path);
   createEntities();
-}
-
-Program::~Program()
-{
-  endCurses();
-}
-
-void Program::initCurses()
-{
-  initscr();
-  noecho();
-  cbreak();
-  nodelay(stdscr, true);
-  start_color();
-  use_default_colors();
-  curs_set(0);
-
-  init_pair(0, COLOR_BLACK, -1);
-  init_pair(1, COLOR_RED, -1);
-  init_pair(2, COLOR_GREEN, -1);
-  init_pair(3, COLOR_YELLOW, -1);
-  init_pair(4, COLOR_BLUE, -1);
-  init_pair(5, COLOR_MAGENTA, -1);
-  init_pair(6, COLOR_CYAN, -1);
-  init_pair(7, COLOR_WHITE, -1);
-}
-
-void Program::createWindows()
-{
-  m_arenaWin = newwin(m_arenaSize.y,
-    m_arenaSize.x,
-    (LINES - m_arenaSize.y) / 2,
-    (COLS - m_arenaSize.x) / 2);
-  m_arenaBorderWin = newwin(m_arenaSize.y + 2,
-    m_arenaSize.x + 2,
-    (LINES - m_arenaSize.y) / 2 - 1,
-    (COLS - m_arenaSize.x) / 2 - 1);
-
-  m_framebuffer.resize(getmaxx(m_arenaWin) * getmaxy(m_arenaWin));
+  createSystems();
+  createScripts();
 }
 
 void Program::loadSprites(Path path)
@@ -60,45 +26,78 @@ void Program::loadSprites(Path path)
   m_sprites.shipBullet = std::make_shared<Sprite>(path / "shipBullet");
   m_sprites.alienBullet = std::make_shared<Sprite>(path / "alienBullet");
 
-  for(int line{}; line < m_alienFormation.y; ++line) {
-    m_sprites.aliens.push_back(std::make_shared<Sprite>(path / ("alien" + std::to_string(line))));
+  // formation rows cycle through alien0, alien1, ... for as many as there are
+  for(int n{}; std::filesystem::exists(path / ("alien" + std::to_string(n))); ++n) {
+    m_sprites.aliens.push_back(std::make_shared<Sprite>(path / ("alien" + std::to_string(n))));
+  }
+  if(m_sprites.aliens.empty()) {
+    throw std::runtime_error("Failed to load alien sprites");
   }
 }
 
 void Program::createEntities()
 {
+  auto& arena = m_config.arenaSize;
+  auto& formation = m_config.alienFormation;
+  m_entities.reserve(formation.y * formation.x + 1);
+  m_entityIDs.aliens.reserve(formation.y * formation.x);
+
   // ship
   YX<float> pos{
-    .y = static_cast<float>(getmaxy(m_arenaWin) - m_sprites.ship->size().y - 2),
-    .x = static_cast<float>((getmaxx(m_arenaWin) - m_sprites.ship->size().x) / 2.f),
+    .y = static_cast<float>(arena.y - m_sprites.ship->size().y - 2),
+    .x = static_cast<float>((arena.x - m_sprites.ship->size().x) / 2.f),
   };
-  int health = 8;
+  int health = m_config.shipHealth;
   YX<float> vel = {0, 0};
   m_entityIDs.ship = spawnEntity(pos, vel, health, m_sprites.ship);
 
-  // aliens
-  YX<int> alienPos{m_alienStartingPoint};
-  for(int y = 0; y < m_alienFormation.y; ++y) {
-    for(int x = 0; x < m_alienFormation.x; ++x) {
+  // the formation has to stay clear of the borders while it sways, and of the ship
+  YX<int> alienPos{m_config.alienStartingPoint};
+  for(int y = 0; y < formation.y; ++y) {
+    auto& sprite = m_sprites.aliens[y % m_sprites.aliens.size()];
+    int width = formation.x * (sprite->size().x + m_config.alienSpacing.x) - m_config.alienSpacing.x;
+    if(alienPos.y + sprite->size().y > pos.y - 1 ||
+       alienPos.x - m_config.alienSway < 1 ||
+       alienPos.x + width + m_config.alienSway > arena.x - 1) {
+      throw std::runtime_error("Invalid level: formation doesn't fit in the arena");
+    }
+    alienPos.y += sprite->size().y + m_config.alienSpacing.y;
+  }
+
+  // aliens are placed relative to the formation origin
+  YX<int> extent{alienPos.y - m_config.alienSpacing.y - m_config.alienStartingPoint.y, 0};
+  for(auto& sprite : m_sprites.aliens) {
+    extent.x = std::max(extent.x, formation.x * (sprite->size().x + m_config.alienSpacing.x));
+  }
+  YX<float> origin{static_cast<float>(m_config.alienStartingPoint.y), static_cast<float>(m_config.alienStartingPoint.x)};
+  m_formation.place(origin, extent);
+
+  YX<int> offset{0, 0};
+  for(int y = 0; y < formation.y; ++y) {
+    auto& sprite = m_sprites.aliens[y % m_sprites.aliens.size()];
+    for(int x = 0; x < formation.x; ++x) {
       // create an entity and registers it
-      pos = {static_cast<float>(alienPos.y), static_cast<float>(alienPos.x)};
+      pos = {static_cast<float>(offset.y), static_cast<float>(offset.x)};
       vel = {0, 1};
       health = 1;
-      Entity::ID id = spawnEntity(pos, vel, health, m_sprites.aliens[y]);
+      Entity alien{pos, vel, health, sprite};
+      alien.anchor(&m_formation.origin());
+      Entity::ID id = alien.id();
+      m_entities.emplace(id, std::move(alien));
       m_entityIDs.aliens.push_back(id);
+      m_formation.add(x, id, offset, sprite->size());
 
       // shifts positions for the next column
-      alienPos.x += m_sprites.aliens[y]->size().x + 2;
+      offset.x += sprite->size().x + m_config.alienSpacing.x;
     }
     // shifts positions for the next line
-    alienPos.y += m_sprites.aliens[y]->size().y + 2;
-    alienPos.x = m_alienStartingPoint.x;
+    offset.y += sprite->size().y + m_config.alienSpacing.y;
+    offset.x = 0;
   }
-}
 
-void Program::endCurses()
-{
-  endwin();
+  // walls are static geometry, painted once
+  paintBorders();
+  m_collisionBuffer.update(m_threadPool);
 }
 
 //////////////////
@@ -107,194 +106,25 @@ Entity::ID Program::spawnEntity(YX<float> pos, YX<float> vel, int health, std::s
 {
   Entity e{pos, vel, health, sprite};
   auto id = e.id();
+  Trace::instant("spawn", id);
   m_collisionBuffer.add(id);
   m_entities.emplace(id, std::move(e));
   return id;
 }
 
-bool Program::updateFramebuffer()
-{
-  // Output is buffered. If there are any changes from the previous one, it is printed
-  // This is done to avoid flickering and unneded screen updates
-  std::vector<chtype> buffer{};
-  buffer.resize(m_framebuffer.size());
-  for(auto& e : m_entities) {
-    drawSprite(buffer, e.second);
-  }
-
-  if(buffer != m_framebuffer) {
-    m_framebuffer = buffer;
-    return true;
-  }
-  return false;
-}
-
-void Program::render(float frameDuration)
-{
-  wclear(stdscr);
-  wclear(m_arenaWin);
-  box(m_arenaBorderWin, 0, 0);
-  // box(arenaWin, 0, 0);
-
-  // Debug
-  bool checkerboard = false;
-  if(m_debugMode) {
-    // Draw Collisions
-    for(int y{}; y < getmaxy(m_arenaWin); ++y) {
-      for(int x{}; x < getmaxx(m_arenaWin); ++x) {
-        wmove(m_arenaWin, y, x);
-        if(m_collisionBuffer.at(YX<int>{y, x}) != CollisionBuffer::Empty) {
-          waddch(m_arenaWin, ACS_CKBOARD | COLOR_PAIR(COLOR_BLACK));
-        } else {
-          waddch(m_arenaWin, ACS_CKBOARD | COLOR_PAIR(COLOR_CYAN + checkerboard));
-        }
-
-        checkerboard = !checkerboard;
-      }
-      checkerboard = !checkerboard;
-    }
-    int framerate = 1.f / frameDuration;
-    mvprintw(0, 0, "timestep[%f]", frameDuration);
-    mvprintw(1, 0, "shipYX[%f, %f]", m_entities.at(m_entityIDs.ship).position().y, m_entities.at(m_entityIDs.ship).position().x);
-    mvprintw(2, 0, "bulletCount[%lu]", m_entityIDs.bullets.size());
-    mvprintw(3, 0, "framerate[%i]", framerate);
-    mvprintw(4, 0, "alienCount[%i]", static_cast<int>(m_entityIDs.aliens.size()));
-    mvprintw(5, 0, "alienVelocity[%f]", static_cast<float>(m_alienVelocity.x));
-  } else {
-    // Draw sprites
-    for(auto& e : m_entities) {
-      auto& entity = e.second;
-      YX<int> drawingPoint{
-        .y = drawingPoint.y = std::round(entity.position().y),
-        .x = drawingPoint.x = std::round(entity.position().x),
-      };
-      wmove(m_arenaWin, drawingPoint.y, drawingPoint.x);
-
-      for(int i{}; i < entity.sprite().bufferSize(); ++i) {
-        if(entity.sprite()[i] == '\n') {
-          ++drawingPoint.y;
-          wmove(m_arenaWin, drawingPoint.y, drawingPoint.x);
-          continue;
-        }
-
-        waddch(m_arenaWin, entity.sprite()[i]);
-      }
-      // flick = !flick;
-      // drawSprite(m_arenaWin, e.second);
-    }
-  }
-
-  std::string shipHP = "HP ";
-  int hp = m_entities.at(m_entityIDs.ship).health();
-  mvprintw(((getmaxy(stdscr) + getmaxy(m_arenaWin)) / 2) + 1, (getmaxx(stdscr) - getmaxx(m_arenaBorderWin)) / 2 + 1, "%s %i", shipHP.c_str(), hp);
-
-  refresh();
-  wrefresh(m_arenaBorderWin);
-  wrefresh(m_arenaWin);
-}
-
-void Program::startingScreen()
-{
-  std::string str_controls = "'l' and ';' for movement, ' ' for shooting";
-  std::string str_start = "press any key to start";
-
-  std::string str_0 = "_______                  ___              ";
-  std::string str_1 = "|_   _|                  | |              ";
-  std::string str_2 = "  | | _ ____   ____ _  __| | ___ _ __ ___ ";
-  std::string str_3 = "  | || '_ \\ \\ / / _` |/ _` |/ _ \\ '__/ __|";
-  std::string str_4 = " _| || | | \\ V / (_| | (_| |  __/ |  \\__ \\";
-  std::string str_5 = " \\___/_| |_|\\_/ \\__,_|\\__,_|\\___|_|  |___/";
-
-
-  nodelay(stdscr, false);
-  do {
-    render(0);
-
-    mvprintw(((getmaxy(stdscr) - getmaxy(m_arenaWin)) / 2) - 8, (getmaxx(stdscr) - str_0.size()) / 2, "%s", str_0.c_str());
-    mvprintw(((getmaxy(stdscr) - getmaxy(m_arenaWin)) / 2) - 7, (getmaxx(stdscr) - str_1.size()) / 2, "%s", str_1.c_str());
-    mvprintw(((getmaxy(stdscr) - getmaxy(m_arenaWin)) / 2) - 6, (getmaxx(stdscr) - str_2.size()) / 2, "%s", str_2.c_str());
-    mvprintw(((getmaxy(stdscr) - getmaxy(m_arenaWin)) / 2) - 5, (getmaxx(stdscr) - str_3.size()) / 2, "%s", str_3.c_str());
-    mvprintw(((getmaxy(stdscr) - getmaxy(m_arenaWin)) / 2) - 4, (getmaxx(stdscr) - str_4.size()) / 2, "%s", str_4.c_str());
-    mvprintw(((getmaxy(stdscr) - getmaxy(m_arenaWin)) / 2) - 3, (getmaxx(stdscr) - str_5.size()) / 2, "%s", str_5.c_str());
-
-    mvprintw(((getmaxy(stdscr) + getmaxy(m_arenaWin)) / 2) + 1, (getmaxx(stdscr) - getmaxx(m_arenaBorderWin)) / 2 + 1, "%s", "        ");
-    mvprintw(((getmaxy(stdscr) + getmaxy(m_arenaWin)) / 2) + 2, (getmaxx(stdscr) - str_controls.size()) / 2 + 1, "%s", str_controls.c_str());
-    mvprintw(((getmaxy(stdscr) + getmaxy(m_arenaWin)) / 2) + 3, (getmaxx(stdscr) - str_start.size()) / 2 + 1, "%s", str_start.c_str());
-    refresh();
-    nodelay(stdscr, false);
-  } while(getch() == ERR);
-  nodelay(stdscr, true);
-}
-
-void Program::endingScreen()
-{
-  std::string won_str = "you won!";
-  std::string lost_str = "your ship was destroyed!";
-  std::string quit_str = "press 'q' to quit.";
-  nodelay(stdscr, false);
-  do {
-    if(m_gameState == GameState::won) {
-      mvprintw(((getmaxy(stdscr) - getmaxy(m_arenaWin)) / 2) - 3, (getmaxx(stdscr) - won_str.size()) / 2, "%s", won_str.c_str());
-    } else if(m_gameState == GameState::lose) {
-      mvprintw(((getmaxy(stdscr) - getmaxy(m_arenaWin)) / 2) - 3, (getmaxx(stdscr) - lost_str.size()) / 2, "%s", lost_str.c_str());
-    }
-    mvprintw(((getmaxy(stdscr) - getmaxy(m_arenaWin)) / 2) - 2, (getmaxx(stdscr) - quit_str.size()) / 2, "%s", quit_str.c_str());
-    refresh();
-  } while(getch() != 'q');
-}
-
-void Program::drawSprite(std::vector<chtype>& buffer, Entity& entity)
-{
-  YX<int> drawingPoint{
-    .y = drawingPoint.y = std::round(entity.position().y),
-    .x = drawingPoint.x = std::round(entity.position().x),
-  };
-
-  for(int i{}; i < entity.sprite().bufferSize(); ++i) {
-    if(entity.sprite()[i] == '\n') {
-      ++drawingPoint.y;
-      buffer[drawingPoint.y * getmaxy(m_arenaWin) + drawingPoint.x] = (entity.sprite()[i]);
-      continue;
-    }
-  }
-  // flick = !flick;
-}
-
-// void Program::drawSprite(WINDOW* win, Entity& entity)
-// {
-//   static bool flick = 0;
-//   YX<int> drawingPoint{
-//     .y = drawingPoint.y = std::round(entity.position().y),
-//     .x = drawingPoint.x = std::round(entity.position().x),
-//   };
-//   wmove(win, drawingPoint.y, drawingPoint.x);
-//
-//   for(int i{}; i < entity.sprite().bufferSize(); ++i) {
-//     if(entity.sprite()[i] == '\n') {
-//       ++drawingPoint.y;
-//       wmove(win, drawingPoint.y, drawingPoint.x);
-//       continue;
-//     }
-//
-//     init_pair(1, COLOR_RED + flick, -1);
-//     waddch(win, entity.sprite()[i] | COLOR_PAIR(1));
-//   }
-//   // flick = !flick;
-// }
-
 void Program::paintBorders()
 {
-  int my{getmaxy(m_arenaWin) - 1};
-  int mx{getmaxx(m_arenaWin) - 1};
+  int my{m_config.arenaSize.y - 1};
+  int mx{m_config.arenaSize.x - 1};
   m_collisionBuffer.paint(YX<int>{0, 0}, YX<int>{0, mx});
   m_collisionBuffer.paint(YX<int>{my, 0}, YX<int>{my, mx});
   m_collisionBuffer.paint(YX<int>{0, 0}, YX<int>{my, 0});
   m_collisionBuffer.paint(YX<int>{0, mx}, YX<int>{my, mx});
 }
 
-void Program::logic(int input, float timeStep, bool& force)
+void Program::input(InputReader::Event const& event, bool& force)
 {
-  auto& ts = timeStep;
+  int input = event.key;
 
   // Show Collisions
   if(input == '1') {
@@ -308,26 +138,12 @@ void Program::logic(int input, float timeStep, bool& force)
     return;
   }
 
-  // Winning/Losing conditions
-  if(m_entityIDs.aliens.size() == 0) {
-    m_gameState = GameState::won;
-    return;
-  } else if(m_entities.at(m_entityIDs.ship).health() == 0) {
-    m_gameState = GameState::lose;
-    return;
-  }
-
   // Move ship and Spawn ship bullets
   Entity& shipEntity = m_entities.at(m_entityIDs.ship);
-  static auto lastShipShot{std::chrono::steady_clock::now()};
   auto moveShip = [&, this](int direction) {
-    shipEntity.position().x += direction * ts * 16.f;
-    std::vector<Entity::ID> collisions = m_collisionBuffer.collides(shipEntity.id());
-    for(auto& e : collisions) {
-      if(e != shipEntity.id()) {
-        shipEntity.position().x += -direction * ts * 16.f;
-        break;
-      }
+    shipEntity.position().x += direction * m_config.shipStep;
+    if(m_collisionBuffer.blocked(shipEntity.id())) {
+      shipEntity.position().x += -direction * m_config.shipStep;
     }
   };
   switch(input) {
@@ -338,177 +154,470 @@ void Program::logic(int input, float timeStep, bool& force)
       moveShip(-1);
       break;
     case ' ':
-      auto now = std::chrono::steady_clock::now();
-      if((now - lastShipShot) >= std::chrono::milliseconds(300)) {
-        lastShipShot = now;
-
-        static bool side{};
-        int health = 3;
-        YX<float> position{
-          .y = shipEntity.position().y - (shipEntity.sprite().size().y / 2.0f) + 1, // (+1) the bullet will be moved latter in this function
-          .x = shipEntity.position().x + side + (shipEntity.sprite().size().x / 2.0f - 1),
-        };
-        YX<float> velocity = {8, 0};
-        Entity::ID id = spawnEntity(position, velocity, health, m_sprites.shipBullet);
-        m_entityIDs.bullets.push_back(id);
-        side = !side;
-      }
+      // ignored while the gun is cooling down
+      m_fireRequested.trigger();
       break;
   }
+}
 
-  // move aliens
-  for(auto& alienID : m_entityIDs.aliens) {
-    auto& alien = m_entities.at(alienID);
-    alien.position().x += (m_alienVelocity.x) * ts;
-  }
-  static int direction{1};
-  static float groupMovement{0.f};
-  constexpr float whereFlip = 4.f;
-  groupMovement += m_alienVelocity.x * ts;
-  if((groupMovement <= -whereFlip && m_alienVelocity.x < 0) || (groupMovement >= whereFlip && m_alienVelocity.x > 0)) {
-    m_alienVelocity.x = m_alienVelocity.x * direction;
-    direction = -direction;
-  }
+void Program::createSystems()
+{
+  auto serial = [this](void (Program::*fun)()) {
+    return [this, fun](std::size_t, std::size_t) { (this->*fun)(); };
+  };
+  auto bulletCount = [this] { return m_entityIDs.bullets.size(); };
+
+  // added in the order a tick used to run them, the scheduler only keeps it
+  // between systems that share data
+  m_systems.add({
+    .name = "input",
+    // policies look at the ship, bullets and aliens, and raycast through the formation
+    .reads = Component::input | Component::entities | Component::bullets | Component::formation,
+    // blocked() uses the collision buffer's query scratch
+    .writes = Component::gameState | Component::ship | Component::collisions | Component::scripts,
+    .update = serial(&Program::inputSystem),
+  });
+  m_systems.add({
+    .name = "particles",
+    .writes = Component::particles,
+    .update = [this](std::size_t, std::size_t) { m_particles.update(m_timeStep); },
+  });
+  m_systems.add({
+    .name = "gameState",
+    .reads = Component::entities | Component::health,
+    .writes = Component::gameState,
+    .update = serial(&Program::gameStateSystem),
+  });
+  // ahead of the scripts, so a turn at the edge is handled in the same tick
+  m_systems.add({
+    .name = "formation",
+    .writes = Component::formation | Component::scripts,
+    .update = serial(&Program::formationSystem),
+  });
+  // reads the game state so it never runs once the last alien is gone
+  m_systems.add({
+    .name = "scripts",
+    .reads = Component::gameState | Component::ship | Component::entities,
+    // spawned bullets are added to the collision buffer
+    .writes = Component::bullets | Component::entities | Component::formation | Component::collisions | Component::random | Component::scripts,
+    .update = [this](std::size_t, std::size_t) { m_scripts.advance(); },
+  });
+  m_systems.add({
+    .name = "bullets",
+    .reads = Component::entities,
+    .writes = Component::bullets,
+    .count = bulletCount,
+    .grain = 256,
+    .update = [this](std::size_t begin, std::size_t end) { bulletSystem(begin, end); },
+  });
+  m_systems.add({
+    .name = "hits",
+    .reads = Component::entities | Component::bullets | Component::formation | Component::collisions,
+    .writes = Component::health,
+    .count = bulletCount,
+    .grain = 256,
+    .update = [this](std::size_t begin, std::size_t end) { hitSystem(begin, end); },
+  });
+  m_systems.add({
+    .name = "bulletSweep",
+    .reads = Component::health,
+    .writes = Component::entities | Component::bullets | Component::collisions | Component::particles,
+    .update = serial(&Program::bulletSweepSystem),
+  });
+  m_systems.add({
+    .name = "alienSweep",
+    .reads = Component::health,
+    .writes = Component::entities | Component::formation | Component::particles,
+    .update = serial(&Program::alienSweepSystem),
+  });
+  // alone in the last stage, so it runs on the simulation thread and may use the pool itself
+  m_systems.add({
+    .name = "collisions",
+    .reads = Component::entities | Component::ship | Component::bullets | Component::formation,
+    .writes = Component::collisions,
+    .update = [this](std::size_t, std::size_t) { m_collisionBuffer.update(m_threadPool); },
+  });
+}
 
-  // Alien Bullets
-  auto now = std::chrono::steady_clock::now();
-  static auto lastAlienShot{std::chrono::steady_clock::now()};
-  if((now - lastAlienShot) >= std::chrono::milliseconds(std::max(30 * m_entityIDs.aliens.size(), std::size_t{250}))) {
-    lastAlienShot = now;
-    // Get front aliens
-    std::vector<Entity::ID> front_aliens{m_entityIDs.aliens.front()};
-    for(auto& e : m_entityIDs.aliens) {
-      auto& ent = m_entities.at(e);
-      auto& stored_ent = m_entities.at(front_aliens.front());
-      if(ent.position().y > stored_ent.position().y) {
-        front_aliens.clear();
-        front_aliens.push_back(e);
-      } else {
-        front_aliens.push_back(e);
-      }
+void Program::createScripts()
+{
+  m_scripts.spawn(alienFireScript());
+  m_scripts.spawn(shipGunScript());
+  m_scripts.spawn(formationScript());
+}
+
+void Program::logic(float timeStep, InputPolicy& policy, bool& force)
+{
+  Trace::Scope trace{"tick", static_cast<int>(m_tick)};
+  m_timeStep = timeStep;
+  m_policy = &policy;
+  m_forceRender = false;
+
+  m_systems.run(m_threadPool, [this] { return m_gameState == GameState::running; });
+  force = m_forceRender;
+}
+
+void Program::inputSystem()
+{
+  // Every keystroke since the last tick
+  m_events.clear();
+  m_policy->poll(InputPolicy::View{
+                   .now = m_now,
+                   .config = m_config,
+                   .ship = m_entities.at(m_entityIDs.ship),
+                   .entities = m_entities,
+                   .aliens = m_entityIDs.aliens,
+                   .bullets = m_entityIDs.bullets,
+                   .collisions = m_collisionBuffer,
+                 },
+    m_events);
+  m_inputLatency = 0;
+  for(auto& event : m_events) {
+    m_inputLatency = std::max(m_inputLatency, std::chrono::duration<float>(m_now - event.time).count());
+    input(event, m_forceRender);
+    if(m_gameState == GameState::quitted) {
+      return;
     }
+  }
+}
 
-    // Shoot at ship
-    int choosen_one = m_random() % front_aliens.size();
-    auto e = front_aliens.at(choosen_one);
+void Program::gameStateSystem()
+{
+  // Winning/Losing conditions
+  if(m_entityIDs.aliens.size() == 0) {
+    m_gameState = GameState::won;
+  } else if(m_entities.at(m_entityIDs.ship).health() <= 0) {
+    m_gameState = GameState::lose;
+  }
+}
+
+auto Program::alienFireScript() -> TickScheduler::Task
+{
+  bool side = false;
+  for(;;) {
+    // the fewer aliens are left the faster they shoot
+    auto interval = std::max(m_config.alienFireInterval * m_entityIDs.aliens.size(), std::size_t(m_config.alienFireMinInterval));
+    co_await m_scripts.sleep(std::chrono::milliseconds(interval));
+
+    // Shoot at ship from the front line of a random column
+    auto e = *m_formation.shooter(m_random);
     auto& ent = m_entities.at(e);
     auto& ship = m_entities.at(m_entityIDs.ship);
 
     // spawn bullet
-    static bool side{};
     int health = 1;
     YX<float> position{
-      .y = ent.position().y + (ent.sprite().size().y),
-      .x = ent.position().x + side,
+      .y = ent.worldPosition().y + (ent.sprite().size().y),
+      .x = ent.worldPosition().x + side,
     };
-    YX<float> velocity = (ent.position() - ship.position()).normalize() * std::fabs(m_alienVelocity.x);
+    YX<float> velocity = (ent.worldPosition() - ship.position()).normalize() * std::fabs(m_alienVelocity.x);
     velocity.x *= -1;
     Entity::ID id = spawnEntity(position, velocity, health, m_sprites.alienBullet);
     m_entityIDs.bullets.push_back(id);
+    Trace::instant("shot", e);
     side = !side;
   }
+}
 
-  // Move bullets
-  for(auto& bulletID : m_entityIDs.bullets) {
-    auto& bullet = m_entities.at(bulletID);
+auto Program::shipGunScript() -> TickScheduler::Task
+{
+  bool side = false;
+  for(;;) {
+    co_await m_fireRequested;
+
+    auto& ship = m_entities.at(m_entityIDs.ship);
+    int health = 3;
+    YX<float> position{
+      .y = ship.position().y - (ship.sprite().size().y / 2.0f) + 1, // (+1) the bullet is moved by the bullets system this tick
+      .x = ship.position().x + side + (ship.sprite().size().x / 2.0f - 1),
+    };
+    YX<float> velocity = {m_config.shipBulletSpeed, 0};
+    Entity::ID id = spawnEntity(position, velocity, health, m_sprites.shipBullet);
+    m_entityIDs.bullets.push_back(id);
+    Trace::instant("shot", ship.id());
+    side = !side;
+
+    co_await m_scripts.sleep(std::chrono::milliseconds(m_config.shipFireInterval));
+  }
+}
+
+auto Program::formationScript() -> TickScheduler::Task
+{
+  for(;;) {
+    co_await m_formationAtEdge;
+    m_alienVelocity.x = -m_alienVelocity.x;
+  }
+}
+
+void Program::formationSystem()
+{
+  // move aliens, only the formation origin is integrated
+  YX<float>& origin = m_formation.origin();
+  origin.x += m_alienVelocity.x * m_timeStep;
+  float groupMovement = origin.x - m_config.alienStartingPoint.x;
+  float whereFlip = m_config.alienSway;
+  if((groupMovement <= -whereFlip && m_alienVelocity.x < 0) || (groupMovement >= whereFlip && m_alienVelocity.x > 0)) {
+    m_formationAtEdge.trigger();
+  }
+}
 
-    bullet.position().x += bullet.velocity().x * ts;
-    bullet.position().y -= bullet.velocity().y * ts;
+void Program::bulletSystem(std::size_t begin, std::size_t end)
+{
+  // Move bullets
+  for(std::size_t i = begin; i < end; ++i) {
+    auto& bullet = m_entities.at(m_entityIDs.bullets[i]);
+    bullet.position().x += bullet.velocity().x * m_timeStep;
+    bullet.position().y -= bullet.velocity().y * m_timeStep;
+  }
+}
 
-    // YX<int> bulletPos{static_cast<int>(bullet.pos.y), static_cast<int>(bullet.pos.x)};
+void Program::hitSystem(std::size_t begin, std::size_t end)
+{
+  // ranges run at once and two bullets can hit the same entity, health is only touched atomically
+  for(std::size_t i = begin; i < end; ++i) {
+    Entity::ID bulletID = m_entityIDs.bullets[i];
+    auto& bullet = m_entities.at(bulletID);
     int hit = m_collisionBuffer.at(bullet.position());
     if(hit != CollisionBuffer::Empty && hit != bulletID) {
       if(hit != CollisionBuffer::Invalid) {
-        m_entities.at(hit).health() -= 1;
+        std::atomic_ref{m_entities.at(hit).health()}.fetch_sub(1, std::memory_order_relaxed);
+        Trace::instant("hit", hit);
       }
-      bullet.health() = 0;
+      std::atomic_ref{bullet.health()}.store(0, std::memory_order_relaxed);
     }
   }
+}
 
+void Program::bulletSweepSystem()
+{
   // Erase Dead Entities (Bullets)
-  std::vector<Entity::ID>
-    bulletsToErase{};
-  for(auto& bulletID : m_entityIDs.bullets) // destroy bullets with health 0
-  {
+  std::erase_if(m_entityIDs.bullets, [this](Entity::ID bulletID) { // destroy bullets with health 0
     auto& bullet = m_entities.at(bulletID);
-    if(bullet.health() == 0) {
-      bulletsToErase.push_back(bulletID);
+    if(bullet.health() > 0) {
+      return false;
     }
-  }
-
-  for(auto& id : bulletsToErase) {
-    m_collisionBuffer.remove(id);
-    m_entities.erase(id);
-    m_entityIDs.bullets.remove(id);
-  }
+    m_particles.burst(bullet.position(), 4, 6, 0.3f);
+    Trace::instant("death", bulletID);
+    m_collisionBuffer.remove(bulletID);
+    m_entities.erase(bulletID);
+    return true;
+  });
+}
 
+void Program::alienSweepSystem()
+{
   // Erase Dead Entities (Aliens)
-  std::vector<Entity::ID> aliensToErase{};
-  for(auto& alienID : m_entityIDs.aliens) // destroy aliens with health 0
-  {
+  std::erase_if(m_entityIDs.aliens, [this](Entity::ID alienID) { // destroy aliens with health 0
     auto& alien = m_entities.at(alienID);
-    if(alien.health() == 0) {
-      // Small alien groups should be faster
-      aliensToErase.push_back(alienID);
-      float increment = 0.250;
-      if(m_alienVelocity.x < 0) {
-        increment *= -1;
-      }
-      m_alienVelocity.x += increment;
+    if(alien.health() > 0) {
+      return false;
+    }
+    YX<float> center{alien.sprite().size().y / 2.f, alien.sprite().size().x / 2.f};
+    m_particles.burst(alien.worldPosition() + center, 24, 8, 0.8f);
+    // Small alien groups should be faster
+    float increment = m_config.alienSpeedup;
+    if(m_alienVelocity.x < 0) {
+      increment *= -1;
+    }
+    m_alienVelocity.x += increment;
+
+    Trace::instant("death", alienID);
+    m_formation.remove(alienID);
+    m_entities.erase(alienID);
+    return true;
+  });
+}
+
+void Program::snapshot(Snapshot& snapshot)
+{
+  // the camera follows the ship and stops at the arena edges
+  auto& arena = m_config.arenaSize;
+  YX<int> view = viewSize();
+  Entity& shipEntity = m_entities.at(m_entityIDs.ship);
+  YX<int> shipCenter{
+    .y = static_cast<int>(shipEntity.position().y) + shipEntity.sprite().size().y / 2,
+    .x = static_cast<int>(shipEntity.position().x) + shipEntity.sprite().size().x / 2,
+  };
+  YX<int> camera{
+    .y = std::clamp(shipCenter.y - view.y / 2, 0, std::max(arena.y - view.y, 0)),
+    .x = std::clamp(shipCenter.x - view.x / 2, 0, std::max(arena.x - view.x, 0)),
+  };
+  snapshot.camera = camera;
+
+  // reuses the storage of the snapshot this slot held before
+  snapshot.drawables.clear();
+  auto draw = [&, this](Entity::ID id, Snapshot::Layer layer) {
+    auto& entity = m_entities.at(id);
+    YX<float> position = entity.worldPosition();
+    snapshot.drawables.push_back({
+      .position = {static_cast<int>(std::round(position.y)) - camera.y, static_cast<int>(std::round(position.x)) - camera.x},
+      .sprite = &entity.sprite(),
+      .layer = layer,
+    });
+  };
+
+  // only what is near the view is handed over, one cell of margin covers rounding
+  YX<int> viewStart{camera.y - 1, camera.x - 1};
+  YX<int> viewEnd{camera.y + view.y + 1, camera.x + view.x + 1};
+  m_formation.forEachMember(viewStart, viewEnd, [&](Entity::ID id) { draw(id, Snapshot::Layer::formation); });
+  for(auto& id : m_entityIDs.bullets) {
+    YX<float> position = m_entities.at(id).position();
+    if(position.y >= viewStart.y && position.y < viewEnd.y && position.x >= viewStart.x && position.x < viewEnd.x) {
+      draw(id, Snapshot::Layer::bullets);
+    }
+  }
+  draw(m_entityIDs.ship, Snapshot::Layer::ship);
+
+  snapshot.sparks.clear();
+  for(std::size_t i{}; i < m_particles.size(); ++i) {
+    YX<float> position = m_particles.position(i);
+    YX<int> cell{static_cast<int>(std::floor(position.y)) - camera.y, static_cast<int>(std::floor(position.x)) - camera.x};
+    if(cell.y >= 0 && cell.y < view.y && cell.x >= 0 && cell.x < view.x) {
+      snapshot.sparks.push_back({cell, m_particles.life(i)});
+    }
+  }
+
+  auto& ship = m_entities.at(m_entityIDs.ship);
+  snapshot.hud = {
+    .ship = ship.position(),
+    .shipHealth = ship.health(),
+    .bulletCount = static_cast<int>(m_entityIDs.bullets.size()),
+    .alienCount = static_cast<int>(m_entityIDs.aliens.size()),
+    .alienVelocity = m_alienVelocity.x,
+    .inputLatency = m_inputLatency,
+    .tickBudget = m_tickBudget,
+    .chunkCount = static_cast<int>(m_collisionBuffer.chunkCount()),
+    .particleCount = static_cast<int>(m_particles.size()),
+  };
+
+  snapshot.debugMode = m_debugMode;
+  snapshot.collisions.clear();
+  if(m_debugMode) {
+    snapshot.collisions.resize(view.y * view.x);
+    for(int y{}; y < view.y; ++y) {
+      std::span row{snapshot.collisions.data() + y * view.x, static_cast<std::size_t>(view.x)};
+      m_collisionBuffer.row(YX<int>{camera.y + y, camera.x}, row);
     }
   }
+}
 
-  for(auto& id : aliensToErase) {
-    m_collisionBuffer.remove(id);
-    m_entities.erase(id);
-    m_entityIDs.aliens.remove(id);
+YX<int> Program::viewSize() const
+{
+  if(m_renderer) {
+    return m_renderer->viewSize();
   }
+  // headless runs still build snapshots, as if shown on an 80x24 terminal
+  return YX<int>{std::min(m_config.arenaSize.y, 22), std::min(m_config.arenaSize.x, 78)};
+}
 
-  // Collisions
-  m_collisionBuffer.update();
-  paintBorders();
+void Program::renderLoop(std::stop_token stop)
+{
+  Trace::threadName("render");
+  FrameScheduler frames{m_config.frameRate};
+
+  while(!stop.stop_requested()) {
+    // a slow terminal only delays frames, never the simulation
+    float frameDuration = frames.wait();
+    if(m_snapshots.update()) {
+      m_renderer->render(m_snapshots.front(), frameDuration, frames.budget());
+    }
+    m_frameTime.store(frames.budget().work, std::memory_order_relaxed);
+    m_frameOverruns.store(frames.budget().overruns, std::memory_order_relaxed);
+  }
+}
+
+void Program::enableMetrics(Path socket_path)
+{
+  m_metrics = std::make_unique<MetricsPublisher>(socket_path);
+}
+
+void Program::publishMetrics()
+{
+  auto allocations = Allocations::count();
+  m_metrics->publish(Metrics{
+    .tick = m_tick,
+    .entities = static_cast<int>(m_entities.size()),
+    .aliens = static_cast<int>(m_entityIDs.aliens.size()),
+    .bullets = static_cast<int>(m_entityIDs.bullets.size()),
+    .collisionChunks = static_cast<int>(m_collisionBuffer.chunkCount()),
+    .tickTime = m_tickBudget.work,
+    .tickOverruns = m_tickBudget.overruns,
+    .frameTime = m_frameTime.load(std::memory_order_relaxed),
+    .frameOverruns = m_frameOverruns.load(std::memory_order_relaxed),
+    .allocations = allocations.allocations,
+    .frees = allocations.frees,
+  });
 }
 
 void Program::run()
 {
-  startingScreen();
-
-  auto& now{std::chrono::steady_clock::now};
-  using Duration = std::chrono::duration<float>;
-  auto updateStartTime = now();
-  auto renderStartTime = now();
-  auto updateEndTime = now();
-  auto renderEndTime = now();
-  Duration frameCounter{0};
-  Duration updateDuration{};
-  Duration minimunTimeStep{0.02083}; // 48 updates per second
+  m_renderer.emplace(m_config);
+  if(!m_recordPath.empty()) {
+    m_renderer->record(m_recordPath);
+  }
+
+  Snapshot title{};
+  snapshot(title);
+  m_renderer->startingScreen(title);
 
+  std::jthread renderThread{[this](std::stop_token stop) { renderLoop(stop); }};
+  m_inputReader.start();
+  KeyboardPolicy keyboard{m_inputReader};
+
+  Trace::threadName("simulation");
+  FrameScheduler ticks{m_config.tickRate};
   while(m_gameState == GameState::running) {
     // time since the last update
-    updateEndTime = now();
-    updateDuration = updateEndTime - updateStartTime;
-    updateStartTime = updateEndTime;
+    float timeStep = ticks.wait();
+    m_now = std::chrono::steady_clock::now();
 
     // input and processing
-    int input = getch();
     bool forceRender = false;
-    logic(input, updateDuration.count(), forceRender);
-
-    // impose a limit on UPS (updates per second)
-    // kinda necessary because only individual keystrokes are registered in the terminal
-    if(updateDuration < minimunTimeStep) {
-      std::this_thread::sleep_for(minimunTimeStep - updateDuration);
+    logic(timeStep, keyboard, forceRender);
+
+    // hand the new state over to the render thread
+    m_tick += 1;
+    m_tickBudget = ticks.budget();
+    snapshot(m_snapshots.back());
+    m_snapshots.publish();
+    if(m_metrics != nullptr) {
+      publishMetrics();
     }
+  }
 
-    // rendering
-    renderEndTime = now();
-    frameCounter += renderEndTime - renderStartTime;
-    renderStartTime = renderEndTime;
-    if(frameCounter > std::chrono::milliseconds(1000 / 24)) {
-      render(frameCounter.count());
-      frameCounter = {};
-    }
+  m_inputReader.stop();
+  renderThread.request_stop();
+  renderThread.join();
+
+  std::string message{};
+  if(m_gameState == GameState::won) {
+    message = "you won!";
+  } else if(m_gameState == GameState::lose) {
+    message = "your ship was destroyed!";
   }
+  m_renderer->endingScreen(message);
+}
+
+std::uint64_t Program::runHeadless(InputPolicy& policy, std::uint64_t ticks)
+{
+  // a fixed step and a simulated clock, the same seed always plays the same game
+  float timeStep = 1.f / m_config.tickRate;
+  auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>{timeStep});
+  m_now = std::chrono::steady_clock::now();
 
-  endingScreen();
+  Trace::threadName("simulation");
+  while(m_gameState == GameState::running && m_tick < ticks) {
+    m_now += step;
+
+    bool forceRender = false;
+    logic(timeStep, policy, forceRender);
+
+    m_tick += 1;
+    snapshot(m_snapshots.back());
+    m_snapshots.publish();
+    if(m_metrics != nullptr) {
+      publishMetrics();
+    }
+  }
+  return m_tick;
 }
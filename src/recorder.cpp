@@ -0,0 +1,230 @@
+#include "recorder.hpp"
+
+#include "trace.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+namespace
+{
+  // the line drawing set curses maps ACS_* to, as UTF-8
+  char const* lineDrawing(chtype ch)
+  {
+    switch(ch) {
+      case '`': return "\u25c6";
+      case 'a': return "\u2592";
+      case 'f': return "\u00b0";
+      case 'g': return "\u00b1";
+      case 'j': return "\u2518";
+      case 'k': return "\u2510";
+      case 'l': return "\u250c";
+      case 'm': return "\u2514";
+      case 'n': return "\u253c";
+      case 'q': return "\u2500";
+      case 't': return "\u251c";
+      case 'u': return "\u2524";
+      case 'v': return "\u2534";
+      case 'w': return "\u252c";
+      case 'x': return "\u2502";
+      case '~': return "\u00b7";
+      case '0': return "\u2588";
+      default: return nullptr;
+    }
+  }
+}
+
+void Recorder::Frame::clear()
+{
+  keyframe = false;
+  runs.clear();
+  cells.clear();
+}
+
+Recorder::Recorder(std::filesystem::path path, YX<int> screenSize) :
+  m_path{path}
+{
+  m_file = std::fopen(path.c_str(), "w");
+  if(m_file == nullptr) {
+    throw std::runtime_error("Failed to open the recording " + path.string());
+  }
+  std::fprintf(m_file,
+    "{\"version\": 2, \"width\": %i, \"height\": %i, \"timestamp\": %lld}\n",
+    screenSize.x,
+    screenSize.y,
+    static_cast<long long>(std::time(nullptr)));
+
+  // a full screen always fits in a slot, whatever was merged before it is replaced
+  std::size_t area = static_cast<std::size_t>(screenSize.y) * screenSize.x;
+  for(std::size_t slot{}; slot < Slots; ++slot) {
+    m_frames[slot].runs.reserve(area);
+    m_frames[slot].cells.reserve(area * 4);
+    if(slot != m_current) {
+      m_free.push(slot);
+    }
+  }
+  m_batch.reserve(1 << 16);
+
+  m_thread = std::jthread{[this](std::stop_token stop) { write(stop); }};
+}
+
+Recorder::~Recorder()
+{
+  m_thread.request_stop();
+  m_thread.join();
+
+  // the frame still being merged into never reached the writer
+  if(!m_frames[m_current].runs.empty() && !m_overflowed) {
+    m_batch.clear();
+    encode(m_frames[m_current]);
+    writeBatch();
+  }
+  if(std::fclose(m_file) != 0 && m_error == 0) {
+    m_error = errno;
+  }
+  // reported here, the renderer has given the terminal back by now
+  if(m_error != 0) {
+    std::fprintf(stderr, "Failed to write the recording %s: %s.\n", m_path.c_str(), std::strerror(m_error));
+  }
+}
+
+void Recorder::cells(YX<int> pos, std::span<chtype const> cells)
+{
+  auto& frame = m_frames[m_current];
+  if(m_overflowed || frame.runs.size() == frame.runs.capacity() || frame.cells.size() + cells.size() > frame.cells.capacity()) {
+    // never grow, the frame is dropped at endFrame()
+    m_overflowed = true;
+    return;
+  }
+  frame.runs.push_back({pos, static_cast<std::uint32_t>(frame.cells.size()), static_cast<std::uint32_t>(cells.size())});
+  frame.cells.insert(frame.cells.end(), cells.begin(), cells.end());
+}
+
+bool Recorder::keyframe()
+{
+  if(!m_keyframe) {
+    return false;
+  }
+  auto& frame = m_frames[m_current];
+  frame.clear();
+  frame.keyframe = true;
+  m_keyframe = false;
+  m_overflowed = false;
+  return true;
+}
+
+void Recorder::endFrame()
+{
+  auto& frame = m_frames[m_current];
+  if(m_overflowed) {
+    // the screen can't be rebuilt from the frames around a gap, start over from a full one
+    frame.clear();
+    m_overflowed = false;
+    m_keyframe = true;
+    m_stats.dropped += 1;
+    Trace::instant("recordDropped", static_cast<int>(m_stats.dropped));
+    return;
+  }
+  if(frame.runs.empty()) {
+    return;
+  }
+
+  frame.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+  m_stats.frames += 1;
+  auto next = m_free.pop();
+  if(!next) {
+    // the writer is behind, the next frame is merged into this one
+    m_stats.coalesced += 1;
+    Trace::instant("recordCoalesced", static_cast<int>(m_stats.coalesced));
+    return;
+  }
+  m_filled.push(m_current);
+  m_current = *next;
+}
+
+////////
+
+void Recorder::write(std::stop_token stop)
+{
+  constexpr auto interval = std::chrono::milliseconds(100);
+
+  // a few frames are written at once, the renderer never wakes this thread
+  while(!stop.stop_requested()) {
+    std::unique_lock lock{m_mutex};
+    m_wake.wait_for(lock, stop, interval, [] { return false; });
+    lock.unlock();
+    flush();
+  }
+  flush();
+}
+
+void Recorder::flush()
+{
+  m_batch.clear();
+  while(auto slot = m_filled.pop()) {
+    encode(m_frames[*slot]);
+    m_frames[*slot].clear();
+    m_free.push(*slot);
+  }
+  if(!m_batch.empty()) {
+    writeBatch();
+  }
+}
+
+void Recorder::writeBatch()
+{
+  if(m_error != 0) {
+    return;
+  }
+  // a full disk would otherwise silently cut the recording short
+  if(std::fwrite(m_batch.data(), 1, m_batch.size(), m_file) != m_batch.size() || std::fflush(m_file) != 0) {
+    m_error = errno;
+  }
+}
+
+void Recorder::encode(Frame const& frame)
+{
+  char text[64];
+  std::snprintf(text, sizeof(text), "[%.6f, \"o\", \"", frame.time);
+  m_batch += text;
+  if(frame.keyframe) {
+    m_batch += "\\u001b[H\\u001b[2J";
+  }
+
+  // attributes carry over between runs, unknown at the start of every frame
+  chtype attributes = ~chtype{};
+  for(auto& run : frame.runs) {
+    std::snprintf(text, sizeof(text), "\\u001b[%i;%iH", run.pos.y + 1, run.pos.x + 1);
+    m_batch += text;
+
+    for(chtype cell : std::span{frame.cells}.subspan(run.offset, run.length)) {
+      chtype cellAttributes = cell & (A_ATTRIBUTES & ~A_ALTCHARSET);
+      if(cellAttributes != attributes) {
+        attributes = cellAttributes;
+        // pair n is color n on the default background, see Renderer::initCurses()
+        m_batch += "\\u001b[0";
+        m_batch += attributes & A_BOLD ? ";1" : "";
+        m_batch += attributes & A_REVERSE ? ";7" : "";
+        if(short pair = PAIR_NUMBER(attributes); pair != 0) {
+          std::snprintf(text, sizeof(text), ";3%i", pair);
+          m_batch += text;
+        }
+        m_batch += 'm';
+      }
+
+      chtype ch = cell & A_CHARTEXT;
+      if(char const* line = (cell & A_ALTCHARSET) ? lineDrawing(ch) : nullptr; line != nullptr) {
+        m_batch += line;
+      } else if(ch == '"' || ch == '\\') {
+        m_batch += '\\';
+        m_batch += static_cast<char>(ch);
+      } else if(ch >= ' ' && ch < 0x7f) {
+        m_batch += static_cast<char>(ch);
+      } else {
+        m_batch += ' ';
+      }
+    }
+  }
+  m_batch += "\\u001b[0m\"]\n";
+}
@@ -0,0 +1,313 @@
+#include "renderer.hpp"
+
+#include "collisionBuffer.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+Renderer::Renderer(Config const& config)
+{
+  initCurses();
+  createLayers(config.arenaSize);
+}
+
+Renderer::~Renderer()
+{
+  endCurses();
+}
+
+void Renderer::initCurses()
+{
+  initscr();
+  noecho();
+  cbreak();
+  nodelay(stdscr, true);
+  start_color();
+  use_default_colors();
+  curs_set(0);
+
+  init_pair(0, COLOR_BLACK, -1);
+  init_pair(1, COLOR_RED, -1);
+  init_pair(2, COLOR_GREEN, -1);
+  init_pair(3, COLOR_YELLOW, -1);
+  init_pair(4, COLOR_BLUE, -1);
+  init_pair(5, COLOR_MAGENTA, -1);
+  init_pair(6, COLOR_CYAN, -1);
+  init_pair(7, COLOR_WHITE, -1);
+}
+
+void Renderer::createLayers(YX<int> arenaSize)
+{
+  // large arenas are cropped to the terminal
+  m_screenSize = {LINES, COLS};
+  YX<int> size{
+    .y = std::max(std::min(arenaSize.y, LINES - 2), 1),
+    .x = std::max(std::min(arenaSize.x, COLS - 2), 1),
+  };
+  m_arenaOrigin = {(LINES - size.y) / 2, (COLS - size.x) / 2};
+  m_viewSize = size;
+
+  // the border never changes, it is drawn once
+  m_background.resize(m_screenSize);
+  YX<int> topLeft{m_arenaOrigin.y - 1, m_arenaOrigin.x - 1};
+  YX<int> bottomRight{m_arenaOrigin.y + size.y, m_arenaOrigin.x + size.x};
+  m_background.fill({topLeft.y, topLeft.x}, {topLeft.y + 1, bottomRight.x}, ACS_HLINE);
+  m_background.fill({bottomRight.y, topLeft.x}, {bottomRight.y + 1, bottomRight.x}, ACS_HLINE);
+  m_background.fill({topLeft.y, topLeft.x}, {bottomRight.y, topLeft.x + 1}, ACS_VLINE);
+  m_background.fill({topLeft.y, bottomRight.x}, {bottomRight.y, bottomRight.x + 1}, ACS_VLINE);
+  m_background.set(topLeft, ACS_ULCORNER);
+  m_background.set({topLeft.y, bottomRight.x}, ACS_URCORNER);
+  m_background.set({bottomRight.y, topLeft.x}, ACS_LLCORNER);
+  m_background.set(bottomRight, ACS_LRCORNER);
+
+  m_framebuffer.resize(size);
+  m_previousFramebuffer.resize(size);
+  m_hud.resize(m_screenSize);
+  m_hud.clear(Compositor::Transparent);
+  m_overlay.resize(m_screenSize);
+  m_overlay.clear(Compositor::Transparent);
+
+  m_compositor.resize(m_screenSize);
+  m_compositor.place(Compositor::Layer::background, &m_background, {0, 0});
+  m_compositor.place(Compositor::Layer::field, &m_framebuffer, m_arenaOrigin);
+  m_compositor.place(Compositor::Layer::hud, &m_hud, {0, 0});
+  m_compositor.place(Compositor::Layer::overlay, &m_overlay, {0, 0});
+}
+
+void Renderer::endCurses()
+{
+  endwin();
+}
+
+//////////////////
+
+YX<int> Renderer::viewSize() const
+{
+  // cached, the simulation thread asks for it while rendering is going on
+  return m_viewSize;
+}
+
+void Renderer::updateFramebuffer(Snapshot const& snapshot)
+{
+  // Output is buffered. Only the rows that differ from the previous one are
+  // recomposed, to avoid flickering and unneded screen updates
+  std::swap(m_framebuffer, m_previousFramebuffer);
+  m_framebuffer.clear();
+
+  // sprites entirely outside the view are culled before sorting
+  m_drawList.clear();
+  for(auto& drawable : snapshot.drawables) {
+    if(m_framebuffer.overlaps(drawable.position, drawable.sprite->size())) {
+      m_drawList.push_back(&drawable);
+    }
+  }
+  std::stable_sort(m_drawList.begin(), m_drawList.end(), [](auto* l, auto* r) { return l->layer < r->layer; });
+
+  for(auto* drawable : m_drawList) {
+    drawSprite(m_framebuffer, *drawable);
+  }
+
+  // sparks cool down from bright stars to dim dots
+  for(auto& spark : snapshot.sparks) {
+    chtype cell = spark.life > 0.5f ? '*' | A_BOLD | COLOR_PAIR(COLOR_YELLOW)
+                : spark.life > 0.2f ? '+' | COLOR_PAIR(COLOR_YELLOW)
+                                    : '.' | COLOR_PAIR(COLOR_RED);
+    m_framebuffer.set(spark.position, cell);
+  }
+}
+
+void Renderer::markFieldChanges()
+{
+  for(int y{}; y < m_viewSize.y; ++y) {
+    if(!std::ranges::equal(m_framebuffer.row(y), m_previousFramebuffer.row(y))) {
+      m_compositor.markDirty(Compositor::Layer::field, {{y, 0}, {y + 1, m_viewSize.x}});
+    }
+  }
+}
+
+template<typename... Args>
+void Renderer::hudLine(int line, YX<int> pos, char const* format, Args... args)
+{
+  // a line is only redrawn when its text changes
+  char text[128];
+  std::snprintf(text, sizeof(text), format, args...);
+  auto& cached = m_hudLines[line];
+  if(cached.pos == pos && cached.text == text) {
+    return;
+  }
+  clearHudLine(line);
+  cached = {pos, text};
+  m_hud.print(pos, cached.text);
+  m_compositor.markDirty(Compositor::Layer::hud, {pos, {pos.y + 1, pos.x + static_cast<int>(cached.text.size())}});
+}
+
+void Renderer::clearHudLine(int line)
+{
+  auto& cached = m_hudLines[line];
+  if(cached.text.empty()) {
+    return;
+  }
+  YX<int> end{cached.pos.y + 1, cached.pos.x + static_cast<int>(cached.text.size())};
+  m_hud.fill(cached.pos, end, Compositor::Transparent);
+  m_compositor.markDirty(Compositor::Layer::hud, {cached.pos, end});
+  cached.text.clear();
+}
+
+void Renderer::render(Snapshot const& snapshot, float frameDuration, FrameScheduler::Budget frameBudget)
+{
+  Trace::Scope trace{"render", static_cast<int>(snapshot.drawables.size())};
+
+  // Debug
+  if(snapshot.debugMode) {
+    // Draw Collisions, built from whole rows of the grid
+    drawCollisions(snapshot);
+  } else {
+    // Draw sprites
+    updateFramebuffer(snapshot);
+  }
+  markFieldChanges();
+
+  if(snapshot.debugMode) {
+    int framerate = 1.f / frameDuration;
+    auto& tickBudget = snapshot.hud.tickBudget;
+    hudLine(0, {0, 0}, "timestep[%f]", frameDuration);
+    hudLine(1, {1, 0}, "shipYX[%f, %f]", snapshot.hud.ship.y, snapshot.hud.ship.x);
+    hudLine(2, {2, 0}, "bulletCount[%i]", snapshot.hud.bulletCount);
+    hudLine(3, {3, 0}, "framerate[%i]", framerate);
+    hudLine(4, {4, 0}, "alienCount[%i]", snapshot.hud.alienCount);
+    hudLine(5, {5, 0}, "alienVelocity[%f]", snapshot.hud.alienVelocity);
+    hudLine(6, {6, 0}, "inputLatency[%f]", snapshot.hud.inputLatency);
+    hudLine(7, {7, 0}, "tickBudget[%3.0f%%, %i overruns, worst %fs]", tickBudget.load * 100, tickBudget.overruns, tickBudget.worstOverrun);
+    hudLine(8, {8, 0}, "frameBudget[%3.0f%%, %i overruns, worst %fs]", frameBudget.load * 100, frameBudget.overruns, frameBudget.worstOverrun);
+    hudLine(9, {9, 0}, "camera[%i, %i]", snapshot.camera.y, snapshot.camera.x);
+    hudLine(10, {10, 0}, "collisionChunks[%i]", snapshot.hud.chunkCount);
+    hudLine(11, {11, 0}, "particles[%i]", snapshot.hud.particleCount);
+  } else {
+    for(int line{}; line < HealthLine; ++line) {
+      clearHudLine(line);
+    }
+  }
+
+  YX<int> health{m_arenaOrigin.y + m_viewSize.y + 1, m_arenaOrigin.x};
+  hudLine(HealthLine, health, "HP  %i", snapshot.hud.shipHealth);
+
+  m_compositor.present();
+}
+
+void Renderer::startingScreen(Snapshot const& snapshot)
+{
+  std::string str_controls = "'l' and ';' for movement, ' ' for shooting";
+  std::string str_start = "press any key to start";
+
+  std::string str_0 = "_______                  ___              ";
+  std::string str_1 = "|_   _|                  | |              ";
+  std::string str_2 = "  | | _ ____   ____ _  __| | ___ _ __ ___ ";
+  std::string str_3 = "  | || '_ \\ \\ / / _` |/ _` |/ _ \\ '__/ __|";
+  std::string str_4 = " _| || | | \\ V / (_| | (_| |  __/ |  \\__ \\";
+  std::string str_5 = " \\___/_| |_|\\_/ \\__,_|\\__,_|\\___|_|  |___/";
+
+  // drawn once, waiting for a key costs nothing
+  int top = m_arenaOrigin.y;
+  int bottom = m_arenaOrigin.y + m_viewSize.y;
+  auto centered = [this](std::string const& str) { return (m_screenSize.x - static_cast<int>(str.size())) / 2; };
+  m_overlay.print({top - 8, centered(str_0)}, str_0);
+  m_overlay.print({top - 7, centered(str_1)}, str_1);
+  m_overlay.print({top - 6, centered(str_2)}, str_2);
+  m_overlay.print({top - 5, centered(str_3)}, str_3);
+  m_overlay.print({top - 4, centered(str_4)}, str_4);
+  m_overlay.print({top - 3, centered(str_5)}, str_5);
+  m_overlay.print({bottom + 2, centered(str_controls) + 1}, str_controls);
+  m_overlay.print({bottom + 3, centered(str_start) + 1}, str_start);
+  m_compositor.markDirty(Compositor::Layer::overlay);
+
+  m_compositor.show(Compositor::Layer::hud, false);
+  render(snapshot, 0);
+
+  nodelay(stdscr, false);
+  while(getch() == ERR) {
+  }
+  nodelay(stdscr, true);
+
+  m_overlay.clear(Compositor::Transparent);
+  m_compositor.markDirty(Compositor::Layer::overlay);
+  m_compositor.show(Compositor::Layer::hud, true);
+}
+
+void Renderer::endingScreen(std::string const& message)
+{
+  // over the last frame of the game
+  std::string quit_str = "press 'q' to quit.";
+  int top = m_arenaOrigin.y;
+  if(!message.empty()) {
+    m_overlay.print({top - 3, (m_screenSize.x - static_cast<int>(message.size())) / 2}, message);
+  }
+  m_overlay.print({top - 2, (m_screenSize.x - static_cast<int>(quit_str.size())) / 2}, quit_str);
+  m_compositor.markDirty(Compositor::Layer::overlay);
+  m_compositor.present();
+
+  nodelay(stdscr, false);
+  while(getch() != 'q') {
+  }
+}
+
+void Renderer::record(std::filesystem::path path)
+{
+  m_recorder = std::make_unique<Recorder>(path, m_screenSize);
+  m_compositor.record(m_recorder.get());
+}
+
+void Renderer::drawCollisions(Snapshot const& snapshot)
+{
+  // entities get a color from their ID so neighbours can be told apart
+  auto color = [](Entity::ID id) -> chtype {
+    auto hash = static_cast<unsigned>(id) * 2654435761u;
+    return COLOR_PAIR(COLOR_RED + (hash >> 16) % 5);
+  };
+
+  std::swap(m_framebuffer, m_previousFramebuffer);
+  for(int y{}; y < m_viewSize.y; ++y) {
+    auto* row = snapshot.collisions.data() + y * m_viewSize.x;
+    for(int x{}; x < m_viewSize.x; ++x) {
+      Entity::ID id = row[x];
+      chtype cell{};
+      if(id == CollisionBuffer::Empty) {
+        bool checkerboard = (x + y) % 2;
+        cell = ACS_CKBOARD | COLOR_PAIR(COLOR_CYAN + checkerboard);
+      } else if(id == CollisionBuffer::Invalid) {
+        cell = ACS_CKBOARD | COLOR_PAIR(COLOR_BLACK);
+      } else {
+        cell = ' ' | A_REVERSE | color(id);
+      }
+      m_framebuffer.set(YX<int>{y, x}, cell);
+    }
+  }
+}
+
+void Renderer::drawSprite(Framebuffer& framebuffer, Snapshot::Drawable const& drawable)
+{
+  framebuffer.blit(*drawable.sprite, drawable.position);
+}
+
+// void Renderer::drawSprite(WINDOW* win, Entity& entity)
+// {
+//   static bool flick = 0;
+//   YX<int> drawingPoint{
+//     .y = drawingPoint.y = std::round(entity.position().y),
+//     .x = drawingPoint.x = std::round(entity.position().x),
+//   };
+//   wmove(win, drawingPoint.y, drawingPoint.x);
+//
+//   for(int i{}; i < entity.sprite().bufferSize(); ++i) {
+//     if(entity.sprite()[i] == '\n') {
+//       ++drawingPoint.y;
+//       wmove(win, drawingPoint.y, drawingPoint.x);
+//       continue;
+//     }
+//
+//     init_pair(1, COLOR_RED + flick, -1);
+//     waddch(win, entity.sprite()[i] | COLOR_PAIR(1));
+//   }
+//   // flick = !flick;
+// }
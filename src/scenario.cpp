@@ -0,0 +1,59 @@
+#include "scenario.hpp"
+
+#include "program.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+std::vector<Scenario> Scenario::builtin()
+{
+  // the ship can't be destroyed, so a run only ends early when every alien is dead
+  Config base{};
+  base.shipHealth = 1 << 20;
+  std::uint64_t minute = 60 * static_cast<std::uint64_t>(base.tickRate);
+
+  Config large{base};
+  large.arenaSize = {200, 400};
+  large.alienFormation = {20, 60};
+
+  // one alien bullet every tick
+  Config storm{base};
+  storm.alienFireInterval = 0;
+  storm.alienFireMinInterval = 1;
+
+  auto idle = [] { return std::make_unique<IdlePolicy>(); };
+  auto random = [] { return std::make_unique<RandomPolicy>(7); };
+  auto spamFire = [] { return std::make_unique<SpamFirePolicy>(); };
+  auto dodgeAndShoot = [] { return std::make_unique<DodgeAndShootPolicy>(); };
+
+  return {
+    {"formation/idle", base, idle, minute, 1},
+    {"formation/dodge-and-shoot", base, dodgeAndShoot, minute, 1},
+    {"large-formation/idle", large, idle, minute, 1},
+    {"large-formation/spam-fire", large, spamFire, minute, 1},
+    {"bullet-storm/random", storm, random, minute, 1},
+    {"bullet-storm/dodge-and-shoot", storm, dodgeAndShoot, minute, 1},
+  };
+}
+
+void runScenarios(std::filesystem::path sprite_path, std::string_view filter, std::ostream& out)
+{
+  for(auto& scenario : Scenario::builtin()) {
+    if(scenario.name.find(filter) == std::string::npos) {
+      continue;
+    }
+
+    scenario.config.validate();
+    Program program{sprite_path, scenario.config};
+    program.seed(scenario.seed);
+    auto policy = scenario.policy();
+
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t ticks = program.runHeadless(*policy, scenario.ticks);
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-30s %6llu ticks %10.0f ticks/s\n", scenario.name.c_str(), static_cast<unsigned long long>(ticks), ticks / seconds);
+    out << line << std::flush;
+  }
+}
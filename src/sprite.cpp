@@ -3,18 +3,24 @@
 #include <cassert>
 #include <fstream>
 
-wchar_t Sprite::operator[](int index)
+wchar_t Sprite::operator[](int index) const
 {
   return m_buffer[index];
 }
 
-YX<int> Sprite::size()
+// rows are padded to the same width and separated by '\n'
+char const* Sprite::row(int y) const
+{
+  return m_buffer.data() + y * (m_size.x + 1);
+}
+
+YX<int> Sprite::size() const
 {
   assert(m_size.y != -1 && m_size.x != -1);
   return m_size;
 }
 
-int Sprite::bufferSize()
+int Sprite::bufferSize() const
 {
   // return m_size.y * (m_size.x + 1);
   return m_buffer.size();
@@ -0,0 +1,50 @@
+#include "systemScheduler.hpp"
+
+#include "trace.hpp"
+
+#include <algorithm>
+
+void SystemScheduler::add(System system)
+{
+  std::size_t stage{};
+  for(std::size_t i{}; i < m_systems.size(); ++i) {
+    if(m_systems[i].conflicts(system)) {
+      stage = std::max(stage, m_stageOf[i] + 1);
+    }
+  }
+
+  if(stage == m_stages.size()) {
+    m_stages.emplace_back();
+  }
+  m_stages[stage].push_back(m_systems.size());
+  m_stageOf.push_back(stage);
+  m_systems.push_back(std::move(system));
+}
+
+void SystemScheduler::run(ThreadPool& pool, std::function<bool()> const& proceed)
+{
+  for(auto& stage : m_stages) {
+    if(!proceed()) {
+      return;
+    }
+
+    m_ranges.clear();
+    for(auto index : stage) {
+      System const& system = m_systems[index];
+      if(!system.count) {
+        m_ranges.push_back({&system, 0, 1});
+        continue;
+      }
+      std::size_t count = system.count();
+      for(std::size_t begin{}; begin < count; begin += system.grain) {
+        m_ranges.push_back({&system, begin, std::min(count, begin + system.grain)});
+      }
+    }
+
+    pool.dispatch(m_ranges.size(), [this](std::size_t i) {
+      Range const& range = m_ranges[i];
+      Trace::Scope trace{range.system->name, static_cast<int>(range.begin)};
+      range.system->update(range.begin, range.end);
+    });
+  }
+}
@@ -0,0 +1,101 @@
+#include "threadPool.hpp"
+
+#include "trace.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+  if(threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  m_workers.reserve(threads - 1);
+  for(unsigned i = 1; i < threads; ++i) {
+    m_workers.emplace_back([this](std::stop_token stop) { work(stop); });
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  for(auto& worker : m_workers) {
+    worker.request_stop();
+  }
+  m_wake.notify_all();
+  // joined here, a worker leaving its last batch still uses the mutex and condition variables
+  m_workers.clear();
+}
+
+void ThreadPool::dispatch(std::size_t tasks, std::function<void(std::size_t)> const& task)
+{
+  if(m_workers.empty() || tasks <= 1) {
+    for(std::size_t i{}; i < tasks; ++i) {
+      task(i);
+    }
+    return;
+  }
+
+  {
+    // a worker still leaving the previous batch would take tasks of this one
+    std::unique_lock lock{m_mutex};
+    m_done.wait(lock, [this] { return m_active == 0; });
+    m_task = &task;
+    m_tasks = tasks;
+    m_next = 0;
+    m_pending = tasks;
+    m_batch += 1;
+  }
+  m_wake.notify_all();
+
+  runTasks(&task, tasks);
+
+  std::unique_lock lock{m_mutex};
+  m_done.wait(lock, [this] { return m_pending == 0; });
+}
+
+void ThreadPool::parallelFor(std::size_t count, std::size_t grain, std::function<void(std::size_t, std::size_t)> const& fun)
+{
+  grain = std::max<std::size_t>(grain, 1);
+  dispatch((count + grain - 1) / grain, [&](std::size_t i) {
+    fun(i * grain, std::min(count, (i + 1) * grain));
+  });
+}
+
+////////
+
+void ThreadPool::work(std::stop_token stop)
+{
+  Trace::threadName("worker");
+  std::uint64_t seen{};
+  while(true) {
+    std::function<void(std::size_t)> const* task{};
+    std::size_t tasks{};
+    {
+      std::unique_lock lock{m_mutex};
+      if(!m_wake.wait(lock, stop, [&, this] { return m_batch != seen; })) {
+        return;
+      }
+      seen = m_batch;
+      task = m_task;
+      tasks = m_tasks;
+      m_active += 1;
+    }
+
+    runTasks(task, tasks);
+
+    std::lock_guard lock{m_mutex};
+    m_active -= 1;
+    m_done.notify_all();
+  }
+}
+
+void ThreadPool::runTasks(std::function<void(std::size_t)> const* task, std::size_t tasks)
+{
+  // a worker joining late finds nothing left and never touches task
+  for(std::size_t i = m_next.fetch_add(1); i < tasks; i = m_next.fetch_add(1)) {
+    (*task)(i);
+    if(m_pending.fetch_sub(1) == 1) {
+      std::lock_guard lock{m_mutex};
+      m_done.notify_all();
+    }
+  }
+}
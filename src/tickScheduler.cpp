@@ -0,0 +1,112 @@
+#include "tickScheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+TickScheduler::Task::Task(Task&& other) noexcept :
+  m_handle{std::exchange(other.m_handle, nullptr)}
+{
+}
+
+TickScheduler::Task::~Task()
+{
+  if(m_handle) {
+    m_handle.destroy();
+  }
+}
+
+void TickScheduler::Event::trigger()
+{
+  for(auto& waiter : m_waiters) {
+    m_scheduler.m_ready.push_back(waiter);
+  }
+  m_waiters.clear();
+}
+
+TickScheduler::TickScheduler(float tickRate, std::size_t slots) :
+  m_tickRate{tickRate},
+  m_wheel(std::max<std::size_t>(slots, 1))
+{
+}
+
+TickScheduler::~TickScheduler()
+{
+  // suspended tasks are dropped without being resumed
+  for(auto& task : m_tasks) {
+    task.destroy();
+  }
+}
+
+void TickScheduler::spawn(Task task)
+{
+  auto handle = std::exchange(task.m_handle, nullptr);
+  m_tasks.push_back(handle);
+  m_ready.push_back(handle);
+}
+
+auto TickScheduler::sleep(std::chrono::milliseconds duration) -> Sleep
+{
+  auto ticks = std::ceil(duration.count() * m_tickRate / 1000.f);
+  return Sleep{*this, static_cast<std::uint64_t>(std::max(ticks, 0.f))};
+}
+
+void TickScheduler::advance()
+{
+  auto slots = m_wheel.size();
+
+  // once per revolution, timers that now fall within it join the wheel
+  if(m_now % slots == 0 && !m_overflow.empty()) {
+    std::erase_if(m_overflow, [&, this](Timer const& timer) {
+      if(timer.due - m_now >= slots) {
+        return false;
+      }
+      m_wheel[timer.due % slots].push_back(timer);
+      return true;
+    });
+  }
+
+  // the slot only holds timers due this tick
+  auto& slot = m_wheel[m_now % slots];
+  for(auto& timer : slot) {
+    m_ready.push_back(timer.handle);
+  }
+  slot.clear();
+
+  // tasks can wake each other within the same tick
+  while(!m_ready.empty()) {
+    std::swap(m_ready, m_resuming);
+    for(auto handle : m_resuming) {
+      resume(handle);
+    }
+    m_resuming.clear();
+  }
+
+  m_now += 1;
+}
+
+////////
+
+void TickScheduler::wakeAt(std::coroutine_handle<> handle, std::uint64_t tick)
+{
+  if(tick - m_now < m_wheel.size()) {
+    m_wheel[tick % m_wheel.size()].push_back({handle, tick});
+  } else {
+    m_overflow.push_back({handle, tick});
+  }
+}
+
+void TickScheduler::resume(std::coroutine_handle<> handle)
+{
+  handle.resume();
+  if(!handle.done()) {
+    return;
+  }
+
+  // finished tasks are freed right away
+  auto it = std::find_if(m_tasks.begin(), m_tasks.end(), [&](auto& task) { return task.address() == handle.address(); });
+  if(it != m_tasks.end()) {
+    it->destroy();
+    m_tasks.erase(it);
+  }
+}
@@ -0,0 +1,117 @@
+#include "trace.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+  struct ThreadBuffer
+  {
+    int tid{};
+    std::string name{};
+    std::vector<Trace::Event> events{};
+    std::size_t dropped{};
+  };
+
+  // buffers are owned here so they outlive the threads that filled them
+  std::mutex buffersMutex{};
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers{};
+  std::filesystem::path outputPath{};
+  std::size_t capacity{};
+
+  thread_local ThreadBuffer* threadBuffer{nullptr};
+
+  ThreadBuffer& buffer()
+  {
+    if(threadBuffer == nullptr) [[unlikely]] {
+      std::scoped_lock lock{buffersMutex};
+      auto& added = buffers.emplace_back(std::make_unique<ThreadBuffer>());
+      added->tid = static_cast<int>(buffers.size());
+      added->events.reserve(capacity);
+      threadBuffer = added.get();
+    }
+    return *threadBuffer;
+  }
+}
+
+void Trace::enable(std::filesystem::path output, std::size_t eventsPerThread)
+{
+  outputPath = output;
+  capacity = eventsPerThread;
+  s_enabled = true;
+}
+
+void Trace::threadName(char const* name)
+{
+  if(s_enabled) {
+    buffer().name = name;
+  }
+}
+
+std::int64_t Trace::now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::record(Event const& event)
+{
+  auto& events = buffer();
+  // never grow, a full buffer drops events instead of allocating mid-frame
+  if(events.events.size() == events.events.capacity()) {
+    events.dropped += 1;
+    return;
+  }
+  events.events.push_back(event);
+}
+
+void Trace::write()
+{
+  if(!s_enabled) {
+    return;
+  }
+
+  std::scoped_lock lock{buffersMutex};
+  std::FILE* file = std::fopen(outputPath.c_str(), "w");
+  if(file == nullptr) {
+    std::fprintf(stderr, "Failed to write the trace %s: %s.\n", outputPath.c_str(), std::strerror(errno));
+    return;
+  }
+
+  std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool first = true;
+  auto separator = [&] {
+    std::fprintf(file, first ? "" : ",\n");
+    first = false;
+  };
+
+  for(auto& thread : buffers) {
+    if(!thread->name.empty()) {
+      separator();
+      std::fprintf(file, R"({"name":"thread_name","ph":"M","pid":1,"tid":%i,"args":{"name":"%s"}})", thread->tid, thread->name.c_str());
+    }
+    if(thread->dropped > 0) {
+      separator();
+      std::fprintf(file, R"({"name":"dropped","ph":"C","pid":1,"tid":%i,"ts":0,"args":{"events":%zu}})", thread->tid, thread->dropped);
+    }
+
+    for(auto& event : thread->events) {
+      separator();
+      std::fprintf(file, R"({"name":"%s","ph":"%c","pid":1,"tid":%i,"ts":%.3f)", event.name, event.phase, thread->tid, event.start / 1000.0);
+      if(event.phase == 'X') {
+        std::fprintf(file, R"(,"dur":%.3f)", event.duration / 1000.0);
+      } else {
+        std::fprintf(file, R"(,"s":"t")");
+      }
+      std::fprintf(file, R"(,"args":{"value":%i}})", event.arg);
+    }
+  }
+
+  std::fprintf(file, "\n]}\n");
+  std::fclose(file);
+}
@@ -0,0 +1,73 @@
+// invaders-top: prints the metrics of a running game, one refresh per update
+//   usage: invaders-top [socket path]   (defaults to $INVADERS_METRICS_SOCKET)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+int connect_to(std::string const& path)
+{
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if(path.size() >= sizeof(address.sun_path)) {
+    return -1;
+  }
+  std::strcpy(address.sun_path, path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if(fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+void print(std::string const& line)
+{
+  // "key=value key=value ..." as an aligned table
+  std::cout << "\x1b[H\x1b[2J";
+  std::istringstream fields{line};
+  for(std::string field; fields >> field;) {
+    auto separator = field.find('=');
+    if(separator == std::string::npos) {
+      continue;
+    }
+    std::printf("%-16s %s\n", field.substr(0, separator).c_str(), field.substr(separator + 1).c_str());
+  }
+  std::fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+  char const* path = argc > 1 ? argv[1] : std::getenv("INVADERS_METRICS_SOCKET");
+  if(path == nullptr) {
+    std::cerr << "usage: invaders-top [socket path], or set INVADERS_METRICS_SOCKET." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int fd = connect_to(path);
+  if(fd < 0) {
+    std::cerr << "Failed to connect to " << path << '.' << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::string pending{};
+  char buffer[1024];
+  for(auto count = read(fd, buffer, sizeof(buffer)); count > 0; count = read(fd, buffer, sizeof(buffer))) {
+    pending.append(buffer, count);
+    for(auto end = pending.find('\n'); end != std::string::npos; end = pending.find('\n')) {
+      print(pending.substr(0, end));
+      pending.erase(0, end + 1);
+    }
+  }
+
+  close(fd);
+  std::cout << "Disconnected." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -27,4 +27,8 @@ target("program")
   add_files("src/**.cpp")
   add_includedirs("inc")
 
+target("invaders-top")
+  set_kind("binary")
+  add_files("tools/invadersTop.cpp")
+
 --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- --- ---